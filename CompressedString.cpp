@@ -0,0 +1,154 @@
+
+#include "CompressedString.h"
+#include "StreamSearcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+// The number of codes decompressed at a time while searching, which keeps
+// each block within the first level of cache
+static const size_t CODES_PER_BLOCK = 512;
+
+// The most characters carried from one block to the next while searching
+static const size_t MAX_CARRIED = 64;
+
+CompressedString::CompressedString()
+	: count(0)
+{
+}
+
+CompressedString::CompressedString(
+		const StringView& text, const std::shared_ptr<const SymbolTable>& table)
+	: symbols(table), count(text.length())
+{
+	if (!this->symbols)
+	{
+		throw std::invalid_argument("A CompressedString needs a SymbolTable");
+	}
+
+	// Compresses into a scratch vector first so that the stored codes take up
+	// exactly as much memory as they need
+	std::vector<unsigned char> encoded;
+	this->symbols->encode(text, encoded);
+
+	this->codes.assign(encoded.begin(), encoded.end());
+}
+
+// -----------------------------------------------------------------------------
+// String Information
+// -----------------------------------------------------------------------------
+
+const size_t CompressedString::length() const
+{
+	return this->count;
+}
+
+const size_t CompressedString::compressedLength() const
+{
+	return this->codes.size();
+}
+
+const std::shared_ptr<const SymbolTable>& CompressedString::table() const
+{
+	return this->symbols;
+}
+
+// -----------------------------------------------------------------------------
+// Searching
+// -----------------------------------------------------------------------------
+
+const bool CompressedString::contains(const StringView& segment) const
+{
+	return this->indexOf(segment) != StringView::npos;
+}
+
+const size_t CompressedString::indexOf(const StringView& segment) const
+{
+	if (segment.length() == 0) return 0;
+	if (segment.length() > this->count) return StringView::npos;
+
+	// Holds the characters carried over from the previous block, then a block
+	// of decompressed characters along with the room decode needs to spare.
+	// Each code decompresses to at most MAX_SYMBOL_LENGTH characters, and a
+	// block may run one code over to keep an escape with its character.
+	char block[MAX_CARRIED +
+			   (CODES_PER_BLOCK + 1) * SymbolTable::MAX_SYMBOL_LENGTH];
+
+	// Longer segments are matched across blocks by a StreamSearcher instead
+	// of by carrying characters over
+	const bool carry = segment.length() - 1 <= MAX_CARRIED;
+	std::unique_ptr<StreamSearcher> searcher;
+	if (!carry) searcher.reset(new StreamSearcher(segment));
+
+	size_t found = StringView::npos;
+	size_t carried = 0;   // The characters carried over
+	size_t blockIdx = 0;  // The index location of block[0] in the whole text
+
+	const size_t total = this->codes.size();
+	size_t idx = 0;
+	while (found == StringView::npos && idx < total)
+	{
+		size_t end = total;
+		if (total - idx > CODES_PER_BLOCK)
+		{
+			// Keeps an escape code together with the character after it
+			end = idx;
+			while (end < idx + CODES_PER_BLOCK)
+			{
+				end += this->codes[end] == SymbolTable::ESCAPE ? 2 : 1;
+			}
+		}
+
+		const size_t decoded = this->symbols->decode(
+				&this->codes[idx], end - idx, block + carried);
+		const StringView view(block, carried + decoded);
+		idx = end;
+
+		if (!carry)
+		{
+			if (searcher->feedUntilMatch(view) != StringView::npos)
+			{
+				found = searcher->position() - segment.length();
+			}
+			continue;
+		}
+
+		// Jumps between candidate first characters with memchr rather than
+		// examining every character
+		const size_t match = view.indexOf(segment);
+		if (match != StringView::npos)
+		{
+			found = blockIdx + match;
+			continue;
+		}
+
+		// Carries over just enough to find a match which spans into the
+		// next block
+		carried = std::min(segment.length() - 1, view.length());
+		std::memmove(block, block + view.length() - carried, carried);
+		blockIdx += view.length() - carried;
+	}
+
+	return found;
+}
+
+// -----------------------------------------------------------------------------
+// Decompressing
+// -----------------------------------------------------------------------------
+
+const String CompressedString::decompress() const
+{
+	if (this->codes.empty()) return String("");
+
+	// Leaves room for what decode may write past the end along with the null
+	// terminating byte, and then hands the buffer straight to the String
+	char* decompressed = new char[this->count + SymbolTable::MAX_SYMBOL_LENGTH];
+	STRING_COUNT_ALLOC(this->count + SymbolTable::MAX_SYMBOL_LENGTH);
+
+	this->symbols->decode(&this->codes[0], this->codes.size(), decompressed);
+	decompressed[this->count] = '\0';
+
+	return String(decompressed, String::AdoptBuffer());
+}
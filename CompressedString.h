@@ -0,0 +1,113 @@
+
+#ifndef COMPRESSEDSTRING_H_
+#define COMPRESSEDSTRING_H_
+
+#include "String.h"
+#include "StringView.h"
+#include "SymbolTable.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * This class holds text compressed with a SymbolTable, for keeping many long
+ * and repetitive Strings (log lines, JSON documents, etc.) in memory at a
+ * fraction of their size. Every CompressedString made with the same table
+ * shares it rather than storing its own copy.
+ *
+ * contains and indexOf search the text by decompressing a small block at a
+ * time and stopping at the first match, so they never rebuild the whole
+ * String. Anything else is done by calling decompress for a String when one
+ * is needed.
+ *
+ * Requires C++11.
+ *
+ * @example
+ * std::shared_ptr<const SymbolTable> table(new SymbolTable(samples));
+ * CompressedString line(logLine, table);
+ * line.contains("ERROR"); // Searches without decompressing the whole line
+ * line.decompress();      // Returns a String equal to logLine
+ */
+class CompressedString
+{
+
+public:
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates an empty CompressedString without a table.
+	 */
+	CompressedString();
+
+	/**
+	 * Compresses the given text.
+	 *
+	 * @param text The text to be compressed
+	 * @param table The table the text is compressed with, which is shared
+	 * @throws std::invalid_argument If the table is null
+	 */
+	CompressedString(const StringView& text,
+					 const std::shared_ptr<const SymbolTable>& table);
+
+// -----------------------------------------------------------------------------
+// String Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The number of characters once decompressed
+	 */
+	const size_t length() const;
+
+	/**
+	 * @return The number of bytes the compressed text takes up, not counting
+	 * 		   the shared table
+	 */
+	const size_t compressedLength() const;
+
+	/**
+	 * @return The table the text was compressed with
+	 */
+	const std::shared_ptr<const SymbolTable>& table() const;
+
+// -----------------------------------------------------------------------------
+// Searching
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @param segment The segment to be found
+	 * @return Whether the segment was found
+	 */
+	const bool contains(const StringView& segment) const;
+
+	/**
+	 * @param segment The segment to be found
+	 * @return The index location of the first matching character in the
+	 * 		   decompressed text; Will return StringView::npos if the segment
+	 * 		   was not found
+	 */
+	const size_t indexOf(const StringView& segment) const;
+
+// -----------------------------------------------------------------------------
+// Decompressing
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return A String holding the decompressed text
+	 */
+	const String decompress() const;
+
+private:
+
+	std::shared_ptr<const SymbolTable> symbols;
+	std::vector<unsigned char> codes;  // The compressed text
+	size_t count;                      // The number of decompressed characters
+
+};
+
+
+
+#endif
@@ -0,0 +1,298 @@
+
+#ifndef FIXEDSTRING_H_
+#define FIXEDSTRING_H_
+
+#include "StringView.h"
+
+#include <cstddef>
+
+// Lists the index locations 0 through N - 1 so that a constructor can copy a
+// string literal one character at a time at compile time
+template <size_t... Idx>
+struct FixedStringIndices {};
+
+template <size_t N, size_t... Idx>
+struct MakeFixedStringIndices : MakeFixedStringIndices<N - 1, N - 1, Idx...> {};
+
+template <size_t... Idx>
+struct MakeFixedStringIndices<0, Idx...>
+{
+	typedef FixedStringIndices<Idx...> type;
+};
+
+/**
+ * This class stores up to N characters in place, without any heap memory.
+ * Every method can be evaluated at compile time, which makes FixedString a
+ * good fit for constants such as configuration keys and header names: a
+ * FixedString built from a string literal costs nothing when the program
+ * runs, and passing it to a String method which takes a StringView needs
+ * neither strlen nor an allocation.
+ *
+ * Methods are written so they also compile as C++11, where each compile time
+ * step counts towards the compiler's recursion limit (usually 512), so they
+ * are intended for short constants rather than large blocks of text.
+ *
+ * @example
+ * constexpr FixedString<5> ERROR_TAG("ERROR");
+ * constexpr auto HOST = makeFixedString("Host"); // A FixedString<4>
+ * static_assert(HOST.length() == 4, "Evaluated at compile time");
+ * line.contains(ERROR_TAG); // No strlen or allocation
+ */
+template <size_t N>
+class FixedString
+{
+
+public:
+
+	/**
+	 * Returned by indexOf when nothing was found.
+	 */
+	static const size_t npos = StringView::npos;
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates an empty FixedString.
+	 */
+	constexpr FixedString()
+		: chars(), count(0)
+	{
+	}
+
+	/**
+	 * Creates a FixedString holding the given string literal, up to its first
+	 * null terminating byte. The literal must fit within N characters.
+	 *
+	 * @param literal The characters to be stored
+	 */
+	template <size_t M>
+	constexpr FixedString(const char (&literal)[M])
+		: FixedString(literal, typename MakeFixedStringIndices<N>::type())
+	{
+		static_assert(M - 1 <= N,
+					  "The literal does not fit in the FixedString");
+	}
+
+// -----------------------------------------------------------------------------
+// String Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The number of characters stored
+	 */
+	constexpr size_t length() const
+	{
+		return this->count;
+	}
+
+	/**
+	 * @return The most characters this FixedString can hold
+	 */
+	constexpr size_t capacity() const
+	{
+		return N;
+	}
+
+	/**
+	 * @return The characters stored, followed by a null terminating byte
+	 */
+	constexpr const char* c_str() const
+	{
+		return this->chars;
+	}
+
+	/**
+	 * @param idx The index location of the character
+	 * @return The character at the given index location
+	 */
+	constexpr char operator[](size_t idx) const
+	{
+		return this->chars[idx];
+	}
+
+	/**
+	 * Finds the first occurrence of the given segment at or after the given
+	 * index location.
+	 *
+	 * @param segment The segment to be found within this FixedString
+	 * @param fromIdx The index location where the search begins
+	 * @return The index location of the first matching character;
+	 * 		   Will return npos if the segment was not found
+	 */
+	template <size_t M>
+	constexpr size_t indexOf(const FixedString<M>& segment,
+							 size_t fromIdx = 0) const
+	{
+		return fromIdx + segment.count > this->count
+				? npos
+				: this->matchesAt(segment, fromIdx, 0)
+					? fromIdx
+					: this->indexOf(segment, fromIdx + 1);
+	}
+
+	template <size_t M>
+	constexpr size_t indexOf(const char (&segment)[M],
+							 size_t fromIdx = 0) const
+	{
+		return this->indexOf(FixedString<M - 1>(segment), fromIdx);
+	}
+
+	/**
+	 * @param segment The segment to be found within this FixedString
+	 * @return Whether the segment was found
+	 */
+	template <size_t M>
+	constexpr bool contains(const FixedString<M>& segment) const
+	{
+		return this->indexOf(segment) != npos;
+	}
+
+	template <size_t M>
+	constexpr bool contains(const char (&segment)[M]) const
+	{
+		return this->indexOf(segment) != npos;
+	}
+
+// -----------------------------------------------------------------------------
+// Conversion
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Refers to the characters stored without copying them. The view is only
+	 * valid for as long as this FixedString exists.
+	 */
+	constexpr operator StringView() const
+	{
+		return StringView(this->chars, this->count);
+	}
+
+// -----------------------------------------------------------------------------
+// Comparison Operators
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @param toCompare The FixedString or string literal being compared
+	 * @return Whether both hold exactly the same characters
+	 */
+	template <size_t M>
+	constexpr bool operator==(const FixedString<M>& toCompare) const
+	{
+		return this->count == toCompare.count &&
+			   this->matchesAt(toCompare, 0, 0);
+	}
+
+	template <size_t M>
+	constexpr bool operator==(const char (&toCompare)[M]) const
+	{
+		return this->operator==(FixedString<M - 1>(toCompare));
+	}
+
+	template <size_t M>
+	constexpr bool operator!=(const FixedString<M>& toCompare) const
+	{
+		return !(this->operator==(toCompare));
+	}
+
+	template <size_t M>
+	constexpr bool operator!=(const char (&toCompare)[M]) const
+	{
+		return !(this->operator==(toCompare));
+	}
+
+	/**
+	 * Orders FixedStrings character by character, with a FixedString coming
+	 * before any longer FixedString it begins.
+	 *
+	 * @param toCompare The FixedString being compared
+	 * @return Whether this FixedString comes first
+	 */
+	template <size_t M>
+	constexpr bool operator<(const FixedString<M>& toCompare) const
+	{
+		return this->lessFrom(toCompare, 0);
+	}
+
+private:
+	template <size_t M> friend class FixedString;
+
+	/**
+	 * Copies the literal into place, padding with null terminating bytes.
+	 */
+	template <size_t M, size_t... Idx>
+	constexpr FixedString(const char (&literal)[M], FixedStringIndices<Idx...>)
+		: chars{ (Idx < M ? literal[Idx] : '\0')..., '\0' },
+		  count(FixedString::measure(literal, 0, M - 1))
+	{
+	}
+
+	/**
+	 * @return The number of characters before the first null terminating
+	 * 		   byte, looking no further than the given limit
+	 */
+	static constexpr size_t measure(const char* literal, size_t idx,
+									size_t limit)
+	{
+		return idx == limit || literal[idx] == '\0'
+				? idx
+				: FixedString::measure(literal, idx + 1, limit);
+	}
+
+	/**
+	 * @return Whether the rest of the segment from segmentIdx matches the
+	 * 		   characters of this FixedString from idx + segmentIdx
+	 */
+	template <size_t M>
+	constexpr bool matchesAt(const FixedString<M>& segment, size_t idx,
+							 size_t segmentIdx) const
+	{
+		return segmentIdx == segment.count ||
+			   (this->chars[idx + segmentIdx] == segment.chars[segmentIdx] &&
+				this->matchesAt(segment, idx, segmentIdx + 1));
+	}
+
+	/**
+	 * @return Whether this FixedString comes first, given that the characters
+	 * 		   before idx are the same in both
+	 */
+	template <size_t M>
+	constexpr bool lessFrom(const FixedString<M>& toCompare, size_t idx) const
+	{
+		return idx == toCompare.count
+				? false
+				: idx == this->count
+					? true
+					: this->chars[idx] != toCompare.chars[idx]
+						? static_cast<unsigned char>(this->chars[idx]) <
+						  static_cast<unsigned char>(toCompare.chars[idx])
+						: this->lessFrom(toCompare, idx + 1);
+	}
+
+	char chars[N + 1]; // The characters, always followed by a null
+					   // terminating byte
+	size_t count;      // The number of characters stored
+
+};
+
+template <size_t N>
+const size_t FixedString<N>::npos;
+
+/**
+ * Creates a FixedString with exactly enough room for the given string literal.
+ *
+ * @example
+ * constexpr auto KEY = makeFixedString("timeout"); // A FixedString<7>
+ *
+ * @param literal The characters to be stored
+ * @return The FixedString
+ */
+template <size_t M>
+constexpr FixedString<M - 1> makeFixedString(const char (&literal)[M])
+{
+	return FixedString<M - 1>(literal);
+}
+
+
+
+#endif
@@ -0,0 +1,1684 @@
+
+#include "Regex.h"
+#include "String.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+const size_t Regex::npos;
+
+// The largest count allowed in a {n,m} quantifier
+static const int MAX_REPEAT = 1000;
+
+// The largest number of instructions a compiled pattern may take up
+static const size_t MAX_PROGRAM_SIZE = 100000;
+
+// The most paths (instructions times index locations) the capture groups of
+// a match are filled in by backtracking over. Longer matches are run through
+// the thread lists instead, whose memory does not grow with the match.
+static const size_t MAX_BACKTRACK_PATHS = 256 * 1024;
+
+/**
+ * @return Whether the given character is part of a word for \w and \b
+ */
+static bool isWordChar(unsigned char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+		   (c >= '0' && c <= '9') || c == '_';
+}
+
+/**
+ * Turns a pattern into the instructions run by Regex. The pattern is first
+ * parsed into a tree of nodes, which is then written out as instructions.
+ */
+class RegexCompiler
+{
+
+public:
+
+	RegexCompiler(Regex& regex)
+		: regex(regex), pattern(regex.source), pos(0),
+		  target(&regex.program), reversed(false), hasAssertions(false)
+	{
+	}
+
+	/**
+	 * Compiles the pattern into the Regex's program.
+	 *
+	 * @throws std::invalid_argument If the pattern is not well formed
+	 */
+	void compile()
+	{
+		size_t root = this->parseAlternation();
+		if (this->pos < this->pattern.size())
+		{
+			// The only thing which stops an alternation early is a ')'
+			this->fail("Unmatched ')'");
+		}
+
+		// Group 0 surrounds the whole pattern
+		this->emitOp(Regex::SAVE, 0);
+		this->emit(root);
+		this->emitOp(Regex::SAVE, 1);
+		this->emitOp(Regex::MATCH, 0);
+
+		// The same pattern with every sequence back to front is used to
+		// find where a match begins once its end is known. Assertions look
+		// at the text around them, which the cached states cannot, so a
+		// pattern with any assertion is always matched without them.
+		if (!this->hasAssertions)
+		{
+			this->target = &this->regex.reverseProgram;
+			this->reversed = true;
+
+			this->emit(root);
+			this->emitOp(Regex::MATCH, 0);
+		}
+	}
+
+private:
+
+	enum NodeType
+	{
+		EMPTY,      // Matches without consuming anything
+		LITERAL,    // Matches the character c
+		ANY_CHAR,   // Matches any character other than a newline
+		CHAR_CLASS, // Matches any character in regex.classes[value]
+		CONCAT,     // Matches each child one after the other
+		ALTERNATE,  // Matches any one child, preferring earlier children
+		GROUP,      // Captures its only child as group value
+		REPEAT,     // Matches its only child between min and max times
+		ASSERTION   // Checks the Regex::Assertion value
+	};
+
+	struct Node
+	{
+		NodeType type;
+		unsigned char c;
+		size_t value;
+		int min;
+		int max;     // -1 when there is no upper limit
+		bool greedy;
+		std::vector<size_t> children;
+	};
+
+// -----------------------------------------------------------------------------
+// Parsing
+// -----------------------------------------------------------------------------
+
+	size_t parseAlternation()
+	{
+		std::vector<size_t> options;
+		options.push_back(this->parseConcatenation());
+
+		while (this->pos < this->pattern.size() &&
+			   this->pattern[this->pos] == '|')
+		{
+			++this->pos;
+			options.push_back(this->parseConcatenation());
+		}
+
+		if (options.size() == 1) return options[0];
+
+		size_t node = this->addNode(ALTERNATE);
+		this->nodes[node].children = options;
+		return node;
+	}
+
+	size_t parseConcatenation()
+	{
+		std::vector<size_t> pieces;
+
+		while (this->pos < this->pattern.size() &&
+			   this->pattern[this->pos] != '|' &&
+			   this->pattern[this->pos] != ')')
+		{
+			pieces.push_back(this->parseRepeat());
+		}
+
+		if (pieces.empty()) return this->addNode(EMPTY);
+		if (pieces.size() == 1) return pieces[0];
+
+		size_t node = this->addNode(CONCAT);
+		this->nodes[node].children = pieces;
+		return node;
+	}
+
+	size_t parseRepeat()
+	{
+		size_t atom = this->parseAtom();
+
+		while (this->pos < this->pattern.size())
+		{
+			int min;
+			int max;
+			if (!this->parseQuantifier(min, max)) break;
+
+			bool greedy = true;
+			if (this->pos < this->pattern.size() &&
+				this->pattern[this->pos] == '?')
+			{
+				greedy = false;
+				++this->pos;
+			}
+
+			size_t node = this->addNode(REPEAT);
+			this->nodes[node].min = min;
+			this->nodes[node].max = max;
+			this->nodes[node].greedy = greedy;
+			this->nodes[node].children.push_back(atom);
+			atom = node;
+		}
+
+		return atom;
+	}
+
+	/**
+	 * Reads a quantifier, if there is one at the current position. A '{'
+	 * which does not begin a valid {n,m} is left to be read as a literal.
+	 */
+	bool parseQuantifier(int& min, int& max)
+	{
+		const char c = this->pattern[this->pos];
+		if (c == '*' || c == '+' || c == '?')
+		{
+			min = (c == '+') ? 1 : 0;
+			max = (c == '?') ? 1 : -1;
+			++this->pos;
+			return true;
+		}
+		if (c != '{') return false;
+
+		size_t scan = this->pos + 1;
+		if (!this->parseNumber(scan, min)) return false;
+
+		max = min;
+		if (scan < this->pattern.size() && this->pattern[scan] == ',')
+		{
+			++scan;
+			max = -1;
+			if (scan < this->pattern.size() && this->pattern[scan] != '}')
+			{
+				if (!this->parseNumber(scan, max)) return false;
+			}
+		}
+		if (scan >= this->pattern.size() || this->pattern[scan] != '}')
+		{
+			return false;
+		}
+
+		if (max != -1 && max < min) this->fail("Invalid repeat range");
+		this->pos = scan + 1;
+		return true;
+	}
+
+	bool parseNumber(size_t& scan, int& number)
+	{
+		const size_t start = scan;
+		number = 0;
+
+		while (scan < this->pattern.size() &&
+			   this->pattern[scan] >= '0' && this->pattern[scan] <= '9')
+		{
+			number = number * 10 + (this->pattern[scan] - '0');
+			if (number > MAX_REPEAT) this->fail("Repeat count is too large");
+			++scan;
+		}
+
+		return scan != start;
+	}
+
+	size_t parseAtom()
+	{
+		const char c = this->pattern[this->pos++];
+		switch (c)
+		{
+		case '*':
+		case '+':
+		case '?':
+			this->fail("Nothing to repeat");
+			break;
+		case '(':
+			return this->parseGroup();
+		case '[':
+			return this->parseClass();
+		case '.':
+			return this->addNode(ANY_CHAR);
+		case '^':
+			return this->addAssertion(Regex::TEXT_START);
+		case '$':
+			return this->addAssertion(Regex::TEXT_END);
+		case '\\':
+			return this->parseEscape();
+		}
+
+		return this->addLiteral(c);
+	}
+
+	size_t parseGroup()
+	{
+		bool capturing = true;
+		if (this->pattern.compare(this->pos, 2, "?:") == 0)
+		{
+			capturing = false;
+			this->pos += 2;
+		} else if (this->pos < this->pattern.size() &&
+				   this->pattern[this->pos] == '?') {
+			this->fail("Unsupported group type");
+		}
+
+		// Groups are numbered by their opening parenthesis, so the number is
+		// taken before any nested groups are parsed
+		size_t group = capturing ? ++this->regex.groups : 0;
+
+		size_t inner = this->parseAlternation();
+		if (this->pos >= this->pattern.size() ||
+			this->pattern[this->pos] != ')')
+		{
+			this->fail("Missing ')'");
+		}
+		++this->pos;
+
+		if (!capturing) return inner;
+
+		size_t node = this->addNode(GROUP);
+		this->nodes[node].value = group;
+		this->nodes[node].children.push_back(inner);
+		return node;
+	}
+
+	size_t parseClass()
+	{
+		std::bitset<256> set;
+
+		bool negated = false;
+		if (this->pos < this->pattern.size() && this->pattern[this->pos] == '^')
+		{
+			negated = true;
+			++this->pos;
+		}
+
+		// A ']' straight after the opening bracket is taken literally
+		bool first = true;
+		while (true)
+		{
+			if (this->pos >= this->pattern.size()) this->fail("Missing ']'");
+			if (this->pattern[this->pos] == ']' && !first) break;
+			first = false;
+
+			unsigned char low;
+			if (this->parseClassMember(set, low)) continue;
+
+			// Handles ranges such as a-z, where a trailing '-' is literal
+			if (this->pos + 1 < this->pattern.size() &&
+				this->pattern[this->pos] == '-' &&
+				this->pattern[this->pos + 1] != ']')
+			{
+				++this->pos;
+
+				unsigned char high;
+				if (this->parseClassMember(set, high))
+				{
+					this->fail("Invalid character class range");
+				}
+				if (high < low) this->fail("Invalid character class range");
+
+				for (int member = low; member <= high; member++)
+				{
+					set.set(member);
+				}
+			} else {
+				set.set(low);
+			}
+		}
+		++this->pos;
+
+		if (negated) set.flip();
+
+		this->regex.classes.push_back(set);
+		size_t node = this->addNode(CHAR_CLASS);
+		this->nodes[node].value = this->regex.classes.size() - 1;
+		return node;
+	}
+
+	/**
+	 * Reads one member of a character class.
+	 *
+	 * @return True if a whole class such as \d was added to the set; False if
+	 * 		   a single character was read into c instead
+	 */
+	bool parseClassMember(std::bitset<256>& set, unsigned char& c)
+	{
+		c = this->pattern[this->pos++];
+		if (c != '\\') return false;
+
+		if (this->pos >= this->pattern.size()) this->fail("Trailing '\\'");
+		const char escaped = this->pattern[this->pos++];
+
+		// Inside a class, \b is a backspace rather than a word boundary
+		if (escaped == 'b')
+		{
+			c = '\b';
+			return false;
+		}
+
+		std::bitset<256> shorthand;
+		if (this->shorthandClass(escaped, shorthand))
+		{
+			set |= shorthand;
+			return true;
+		}
+
+		c = this->escapedChar(escaped);
+		return false;
+	}
+
+	size_t parseEscape()
+	{
+		if (this->pos >= this->pattern.size()) this->fail("Trailing '\\'");
+		const char escaped = this->pattern[this->pos++];
+
+		if (escaped == 'b') return this->addAssertion(Regex::WORD_BOUNDARY);
+		if (escaped == 'B') return this->addAssertion(Regex::NOT_WORD_BOUNDARY);
+
+		std::bitset<256> set;
+		if (this->shorthandClass(escaped, set))
+		{
+			this->regex.classes.push_back(set);
+			size_t node = this->addNode(CHAR_CLASS);
+			this->nodes[node].value = this->regex.classes.size() - 1;
+			return node;
+		}
+
+		return this->addLiteral(this->escapedChar(escaped));
+	}
+
+	/**
+	 * Fills the set for shorthand classes such as \d.
+	 *
+	 * @return Whether the escaped character names a shorthand class
+	 */
+	bool shorthandClass(char escaped, std::bitset<256>& set)
+	{
+		switch (escaped)
+		{
+		case 'd':
+		case 'D':
+			for (int c = '0'; c <= '9'; c++) set.set(c);
+			break;
+		case 'w':
+		case 'W':
+			for (int c = 0; c < 256; c++)
+			{
+				if (isWordChar(static_cast<unsigned char>(c))) set.set(c);
+			}
+			break;
+		case 's':
+		case 'S':
+			set.set(' ');
+			set.set('\t');
+			set.set('\n');
+			set.set('\r');
+			set.set('\f');
+			set.set('\v');
+			break;
+		default:
+			return false;
+		}
+
+		// Uppercase shorthands match everything the lowercase ones do not
+		if (escaped >= 'A' && escaped <= 'Z') set.flip();
+		return true;
+	}
+
+	unsigned char escapedChar(char escaped)
+	{
+		switch (escaped)
+		{
+		case 't': return '\t';
+		case 'n': return '\n';
+		case 'r': return '\r';
+		case 'f': return '\f';
+		case 'v': return '\v';
+		case '0': return '\0';
+		}
+
+		// Letters and digits are reserved for future escapes
+		if (isWordChar(static_cast<unsigned char>(escaped)))
+		{
+			this->fail(std::string("Unknown escape '\\") + escaped + "'");
+		}
+
+		return escaped;
+	}
+
+	size_t addNode(NodeType type)
+	{
+		Node node;
+		node.type = type;
+		node.c = 0;
+		node.value = 0;
+		node.min = 0;
+		node.max = 0;
+		node.greedy = true;
+
+		this->nodes.push_back(node);
+		return this->nodes.size() - 1;
+	}
+
+	size_t addLiteral(char c)
+	{
+		size_t node = this->addNode(LITERAL);
+		this->nodes[node].c = static_cast<unsigned char>(c);
+		return node;
+	}
+
+	size_t addAssertion(Regex::Assertion assertion)
+	{
+		this->hasAssertions = true;
+
+		size_t node = this->addNode(ASSERTION);
+		this->nodes[node].value = assertion;
+		return node;
+	}
+
+	void fail(const std::string& reason)
+	{
+		throw std::invalid_argument("Invalid regex \"" + this->pattern +
+									"\": " + reason);
+	}
+
+// -----------------------------------------------------------------------------
+// Code Generation
+// -----------------------------------------------------------------------------
+
+	size_t emitOp(Regex::Opcode op, size_t x, size_t y = 0)
+	{
+		if (this->target->size() >= MAX_PROGRAM_SIZE)
+		{
+			this->fail("Pattern is too large");
+		}
+
+		Regex::Instruction instruction;
+		instruction.op = op;
+		instruction.c = 0;
+		instruction.x = x;
+		instruction.y = y;
+
+		this->target->push_back(instruction);
+		return this->target->size() - 1;
+	}
+
+	size_t here() const
+	{
+		return this->target->size();
+	}
+
+	/**
+	 * Writes out a SPLIT which either enters the instructions following it or
+	 * skips to a location patched in later.
+	 */
+	void patchSplit(size_t split, size_t skip, bool greedy)
+	{
+		Regex::Instruction& instruction = (*this->target)[split];
+		instruction.x = greedy ? split + 1 : skip;
+		instruction.y = greedy ? skip : split + 1;
+	}
+
+	void emit(size_t idx)
+	{
+		// Copied since emitting may add to the list of nodes
+		const Node node = this->nodes[idx];
+
+		switch (node.type)
+		{
+		case EMPTY:
+			break;
+		case LITERAL:
+			(*this->target)[this->emitOp(Regex::CHAR, 0)].c = node.c;
+			break;
+		case ANY_CHAR:
+			this->emitOp(Regex::ANY, 0);
+			break;
+		case CHAR_CLASS:
+			this->emitOp(Regex::CLASS, node.value);
+			break;
+		case ASSERTION:
+			this->emitOp(Regex::ASSERT, node.value);
+			break;
+		case CONCAT:
+			for (size_t child = 0; child < node.children.size(); child++)
+			{
+				this->emit(node.children[this->reversed
+						? node.children.size() - 1 - child : child]);
+			}
+			break;
+		case GROUP:
+			// Only the forward program records capture groups
+			if (this->reversed)
+			{
+				this->emit(node.children[0]);
+				break;
+			}
+
+			this->emitOp(Regex::SAVE, node.value * 2);
+			this->emit(node.children[0]);
+			this->emitOp(Regex::SAVE, node.value * 2 + 1);
+			break;
+		case ALTERNATE:
+			this->emitAlternation(node);
+			break;
+		case REPEAT:
+			this->emitRepeat(node);
+			break;
+		}
+	}
+
+	void emitAlternation(const Node& node)
+	{
+		std::vector<size_t> jumps;
+
+		// Each option but the last tries itself first and otherwise moves on
+		// to the next option
+		for (size_t option = 0; option + 1 < node.children.size(); option++)
+		{
+			size_t split = this->emitOp(Regex::SPLIT, 0);
+			this->emit(node.children[option]);
+			jumps.push_back(this->emitOp(Regex::JUMP, 0));
+			this->patchSplit(split, this->here(), true);
+		}
+		this->emit(node.children.back());
+
+		for (size_t jump = 0; jump < jumps.size(); jump++)
+		{
+			(*this->target)[jumps[jump]].x = this->here();
+		}
+	}
+
+	void emitRepeat(const Node& node)
+	{
+		const size_t child = node.children[0];
+
+		for (int count = 0; count < node.min; count++)
+		{
+			this->emit(child);
+		}
+
+		if (node.max == -1)
+		{
+			// Loops back to a SPLIT which decides whether to go again
+			size_t split = this->emitOp(Regex::SPLIT, 0);
+			this->emit(child);
+			this->emitOp(Regex::JUMP, split);
+			this->patchSplit(split, this->here(), node.greedy);
+			return;
+		}
+
+		// Every optional repetition may skip straight to the end
+		std::vector<size_t> splits;
+		for (int count = node.min; count < node.max; count++)
+		{
+			splits.push_back(this->emitOp(Regex::SPLIT, 0));
+			this->emit(child);
+		}
+		for (size_t split = 0; split < splits.size(); split++)
+		{
+			this->patchSplit(splits[split], this->here(), node.greedy);
+		}
+	}
+
+	Regex& regex;
+	const std::string& pattern;
+	size_t pos;               // The next character of the pattern to be read
+	std::vector<Node> nodes;  // Every node parsed so far
+
+	std::vector<Regex::Instruction>* target; // The program being written
+	bool reversed;            // Whether sequences are written back to front
+	bool hasAssertions;       // Whether the pattern has ^, $, \b or \B
+
+};
+
+/**
+ * The threads which are alive at one index location. Each instruction may
+ * appear at most once, so its capture slots are stored at a fixed place.
+ */
+struct Regex::ThreadList
+{
+	ThreadList(size_t programSize, size_t slots)
+		: slots(slots), generation(1), onList(programSize, 0),
+		  captures(programSize * slots), seed(slots)
+	{
+		this->pcs.reserve(programSize);
+	}
+
+	void clear()
+	{
+		this->pcs.clear();
+
+		// Bumping the generation empties onList without touching it
+		if (++this->generation == 0)
+		{
+			std::fill(this->onList.begin(), this->onList.end(), 0);
+			this->generation = 1;
+		}
+	}
+
+	size_t slots;                     // Capture slots per thread
+	unsigned int generation;          // Marks the entries of onList in use
+	std::vector<size_t> pcs;          // The threads, highest priority first
+	std::vector<unsigned int> onList; // Whether each pc is in the list
+	std::vector<size_t> captures;     // slots entries for each pc
+	std::vector<size_t> seed;         // The slots of a newly started thread
+};
+
+/**
+ * A deterministic version of a program which is built up lazily as the text
+ * is read. Each state stands for an ordered list of threads without any
+ * capture slots, so once a step has been worked out, taking it again is a
+ * single table lookup. Only programs without assertions can be run this way.
+ */
+struct Regex::Dfa
+{
+	// Marks a transition which has not been worked out yet
+	static const int UNKNOWN = -1;
+
+	// Returned once the states take up too much room to be worth caching
+	static const int FAILED = -2;
+
+	// The most states kept before giving up on the Dfa
+	static const size_t MAX_STATES = 4096;
+
+	/**
+	 * @param firstMatch True to search for the first match, starting a new
+	 * 		  thread at every character until one is found; False to find the
+	 * 		  longest match from the first character only
+	 */
+	Dfa(const std::vector<Instruction>& program,
+		const std::vector<std::bitset<256> >& classes, bool firstMatch)
+		: program(program), classes(classes), firstMatch(firstMatch),
+		  initial(UNKNOWN), marks(program.size(), 0), generation(0)
+	{
+	}
+
+	/**
+	 * @return The state before any characters have been read
+	 */
+	int start()
+	{
+		if (this->initial == UNKNOWN)
+		{
+			std::vector<size_t> list;
+
+			++this->generation;
+			this->addClosure(0, list);
+
+			const int state = this->intern(list, this->firstMatch);
+			if (state == FAILED) return FAILED;
+
+			this->initial = state;
+		}
+
+		return this->initial;
+	}
+
+	/**
+	 * Throws away every state, which makes room to build them up again once
+	 * MAX_STATES has been reached.
+	 */
+	void clear()
+	{
+		this->states.clear();
+		this->ids.clear();
+		this->transitions.clear();
+		this->initial = UNKNOWN;
+	}
+
+	/**
+	 * @return The state reached by reading the given character
+	 */
+	int step(int state, unsigned char c)
+	{
+		const size_t slot = static_cast<size_t>(state) * 256 + c;
+		if (this->transitions[slot] == UNKNOWN)
+		{
+			const int next = this->build(state, c);
+			if (next == FAILED) return FAILED;
+
+			this->transitions[slot] = next;
+		}
+
+		return this->transitions[slot];
+	}
+
+	bool isMatching(int state) const
+	{
+		return this->states[state].matching;
+	}
+
+	bool isDead(int state) const
+	{
+		return this->states[state].pcs.empty();
+	}
+
+	struct State
+	{
+		std::vector<size_t> pcs; // The threads, highest priority first
+		bool seeding;            // Whether a new thread starts at each step
+		bool matching;           // Whether a match ends here
+	};
+
+	/**
+	 * Works out the state reached from the given state by reading c.
+	 */
+	int build(int state, unsigned char c)
+	{
+		std::vector<size_t> list;
+		++this->generation;
+
+		// Copied since interning may add to the list of states
+		const State from = this->states[state];
+		for (size_t thread = 0; thread < from.pcs.size(); thread++)
+		{
+			const Instruction& instruction = this->program[from.pcs[thread]];
+
+			bool consumed = false;
+			if (instruction.op == CHAR) {
+				consumed = c == instruction.c;
+			} else if (instruction.op == ANY) {
+				consumed = c != '\n';
+			} else if (instruction.op == CLASS) {
+				consumed = this->classes[instruction.x][c];
+			}
+
+			if (consumed) this->addClosure(from.pcs[thread] + 1, list);
+		}
+
+		// The new thread has the lowest priority of all
+		if (from.seeding) this->addClosure(0, list);
+
+		return this->intern(list, from.seeding);
+	}
+
+	/**
+	 * Adds the thread at pc, along with every thread reachable from it
+	 * without consuming a character, in the same order as Regex::addThread.
+	 */
+	void addClosure(size_t pc, std::vector<size_t>& list)
+	{
+		this->pending.push_back(pc);
+
+		while (!this->pending.empty())
+		{
+			const size_t next = this->pending.back();
+			this->pending.pop_back();
+
+			if (this->marks[next] == this->generation) continue;
+			this->marks[next] = this->generation;
+
+			const Instruction& instruction = this->program[next];
+			switch (instruction.op)
+			{
+			case SPLIT:
+				// x is pushed last so that it is followed first
+				this->pending.push_back(instruction.y);
+				this->pending.push_back(instruction.x);
+				break;
+			case JUMP:
+				this->pending.push_back(instruction.x);
+				break;
+			case SAVE:
+				this->pending.push_back(next + 1);
+				break;
+			default:
+				list.push_back(next);
+				break;
+			}
+		}
+	}
+
+	/**
+	 * Finds or creates the state for the given list of threads.
+	 */
+	int intern(std::vector<size_t>& list, bool seeding)
+	{
+		bool matching = false;
+		for (size_t thread = 0; thread < list.size(); thread++)
+		{
+			if (this->program[list[thread]].op != MATCH) continue;
+
+			matching = true;
+			if (this->firstMatch)
+			{
+				// Threads after a match have a lower priority, so they are
+				// dropped, and no new threads are started from here on
+				list.resize(thread + 1);
+				seeding = false;
+			}
+			break;
+		}
+
+		// Tells seeding states apart from the others with a final entry
+		list.push_back(seeding ? npos : npos - 1);
+
+		std::map<std::vector<size_t>, int>::const_iterator found =
+				this->ids.find(list);
+		if (found != this->ids.end()) return found->second;
+
+		if (this->states.size() >= MAX_STATES) return FAILED;
+
+		const int id = static_cast<int>(this->states.size());
+		this->ids[list] = id;
+
+		list.pop_back();
+		State state;
+		state.pcs = list;
+		state.seeding = seeding;
+		state.matching = matching;
+		this->states.push_back(state);
+		this->transitions.resize(this->transitions.size() + 256, UNKNOWN);
+
+		return id;
+	}
+
+	const std::vector<Instruction>& program;
+	const std::vector<std::bitset<256> >& classes;
+	bool firstMatch;
+
+	int initial;                            // The start state, once built
+	std::vector<State> states;
+	std::map<std::vector<size_t>, int> ids; // Finds a state by its threads
+	std::vector<int> transitions;           // 256 entries for each state
+
+	std::vector<unsigned int> marks; // Whether each pc is in the closure
+	unsigned int generation;         // Marks the entries of marks in use
+	std::vector<size_t> pending;     // The pcs waiting to be followed
+};
+
+const int Regex::Dfa::UNKNOWN;
+const int Regex::Dfa::FAILED;
+const size_t Regex::Dfa::MAX_STATES;
+
+/**
+ * Everything a search needs which can be reused from one search to the next.
+ * A Regex keeps these in its pool between searches.
+ */
+struct Regex::Scratch
+{
+	// The number of times the Dfas may run out of room before they are
+	// given up on, for patterns whose states are too many to cache
+	static const size_t MAX_DFA_FAILURES = 8;
+
+	Scratch(const Regex& regex)
+		: current(regex.program.size(), (regex.groups + 1) * 2),
+		  next(regex.program.size(), (regex.groups + 1) * 2),
+		  boundsCurrent(regex.program.size(), 2),
+		  boundsNext(regex.program.size(), 2),
+		  forward(regex.program, regex.classes, true),
+		  reverse(regex.reverseProgram, regex.classes, false),
+		  anchored(regex.program, regex.classes, false),
+		  useDfa(!regex.reverseProgram.empty()), dfaFailures(0)
+	{
+	}
+
+	/**
+	 * Records that the Dfas could not be used for a search.
+	 */
+	void dfaFailed()
+	{
+		if (++this->dfaFailures >= MAX_DFA_FAILURES) this->useDfa = false;
+	}
+
+	ThreadList current;       // Used to fill in every capture group
+	ThreadList next;
+	ThreadList boundsCurrent; // Used to find only group 0
+	ThreadList boundsNext;
+
+	Dfa forward;              // Finds where the first match ends
+	Dfa reverse;              // Finds where that match begins
+	Dfa anchored;             // Finds whether the whole text matches
+	bool useDfa;              // Whether the Dfas can still be used
+	size_t dfaFailures;       // The number of searches the Dfas failed
+
+	/**
+	 * A path waiting to be tried by backtrack, or a capture slot waiting to
+	 * be restored once every path after it has failed.
+	 */
+	struct Job
+	{
+		size_t pc;
+		size_t idx;  // The index location, or the value restored
+		size_t slot; // The capture slot restored, or npos for a path
+	};
+
+	std::vector<Job> jobs;             // Used by backtrack
+	std::vector<unsigned int> visited; // One bit per instruction and index
+	std::vector<size_t> captures;      // The slots of the current path
+};
+
+const size_t Regex::Scratch::MAX_DFA_FAILURES;
+
+/**
+ * The Scratches of a Regex which are not in use by any search.
+ */
+struct Regex::ScratchPool
+{
+	std::mutex lock;
+	std::vector<std::unique_ptr<Scratch> > scratches;
+};
+
+/**
+ * Borrows a Scratch from a Regex's pool for the length of one call, creating
+ * one if every Scratch is in use, and puts it back afterwards.
+ */
+class Regex::ScratchLease
+{
+
+public:
+
+	ScratchLease(const Regex& regex)
+		: regex(regex)
+	{
+		{
+			std::lock_guard<std::mutex> lock(regex.pool->lock);
+			std::vector<std::unique_ptr<Scratch> >& scratches =
+					regex.pool->scratches;
+			if (!scratches.empty())
+			{
+				this->borrowed = std::move(scratches.back());
+				scratches.pop_back();
+			}
+		}
+
+		// Created outside of the lock, as other searches need not wait on it
+		if (!this->borrowed) this->borrowed.reset(new Scratch(regex));
+	}
+
+	~ScratchLease()
+	{
+		try
+		{
+			std::lock_guard<std::mutex> lock(this->regex.pool->lock);
+			this->regex.pool->scratches.push_back(std::move(this->borrowed));
+		}
+		catch (...)
+		{
+			// The Scratch is simply freed if it cannot be put back
+		}
+	}
+
+	Scratch& scratch()
+	{
+		return *this->borrowed;
+	}
+
+private:
+
+	const Regex& regex;
+	std::unique_ptr<Scratch> borrowed;
+
+};
+
+// -----------------------------------------------------------------------------
+// Match
+// -----------------------------------------------------------------------------
+
+Regex::Match::Match()
+{
+}
+
+const bool Regex::Match::found() const
+{
+	return !this->positions.empty();
+}
+
+const size_t Regex::Match::groupCount() const
+{
+	return this->positions.size() / 2;
+}
+
+const size_t Regex::Match::start(size_t group) const
+{
+	if (group >= this->groupCount()) return npos;
+
+	return this->positions[group * 2];
+}
+
+const size_t Regex::Match::end(size_t group) const
+{
+	if (group >= this->groupCount()) return npos;
+
+	return this->positions[group * 2 + 1];
+}
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+Regex::Regex(const String& pattern)
+	: source(pattern.toStdString()), groups(0), hasFirstBytes(false),
+	  onlyFirstByte(-1), pool(NULL)
+{
+	RegexCompiler compiler(*this);
+	compiler.compile();
+
+	this->computeFirstBytes();
+	this->computeLiteral();
+
+	// Created last, as nothing frees it if compiling throws
+	this->pool = new ScratchPool();
+}
+
+Regex::Regex(const Regex& toCopy)
+	: source(toCopy.source), program(toCopy.program),
+	  reverseProgram(toCopy.reverseProgram), classes(toCopy.classes),
+	  groups(toCopy.groups), hasFirstBytes(toCopy.hasFirstBytes),
+	  firstBytes(toCopy.firstBytes), onlyFirstByte(toCopy.onlyFirstByte),
+	  literal(toCopy.literal), pool(new ScratchPool())
+{
+}
+
+Regex::~Regex()
+{
+	delete this->pool;
+	this->pool = NULL;
+}
+
+// -----------------------------------------------------------------------------
+// Regex Information
+// -----------------------------------------------------------------------------
+
+const std::string& Regex::pattern() const
+{
+	return this->source;
+}
+
+const size_t Regex::groupCount() const
+{
+	return this->groups;
+}
+
+// -----------------------------------------------------------------------------
+// Matching
+// -----------------------------------------------------------------------------
+
+const bool Regex::matches(const StringView& text) const
+{
+	if (!this->literal.empty())
+	{
+		return text == StringView(this->literal.data(), this->literal.length());
+	}
+
+	ScratchLease lease(*this);
+	Scratch& scratch = lease.scratch();
+
+	if (scratch.useDfa)
+	{
+		bool failed = false;
+		const bool matched = this->matchesDfa(text, scratch, failed);
+		if (!failed) return matched;
+
+		scratch.dfaFailed();
+	}
+
+	// Only group 0 is kept track of, as the groups are not reported
+	Match match;
+	return this->run(text, 0, text.length(), WHOLE,
+					 scratch.boundsCurrent, scratch.boundsNext, match);
+}
+
+const Regex::Match Regex::find(const StringView& text, size_t fromIdx) const
+{
+	Match match;
+	if (fromIdx <= text.length())
+	{
+		ScratchLease lease(*this);
+		this->search(text, fromIdx, lease.scratch(), match);
+	}
+
+	return match;
+}
+
+std::vector<Regex::Match> Regex::findAll(const StringView& text) const
+{
+	// The thread lists and cached states are shared by every search
+	ScratchLease lease(*this);
+	Scratch& scratch = lease.scratch();
+
+	std::vector<Match> found;
+	size_t fromIdx = 0;
+	while (fromIdx <= text.length())
+	{
+		Match match;
+		if (!this->search(text, fromIdx, scratch, match)) break;
+
+		// An empty match would be found again at the same place, so the
+		// search moves on by one character
+		fromIdx = match.end();
+		if (match.end() == match.start()) ++fromIdx;
+
+		found.push_back(match);
+	}
+
+	return found;
+}
+
+// -----------------------------------------------------------------------------
+// Operators
+// -----------------------------------------------------------------------------
+
+Regex& Regex::operator=(const Regex& toEqual)
+{
+	if (this != &toEqual)
+	{
+		this->source = toEqual.source;
+		this->program = toEqual.program;
+		this->reverseProgram = toEqual.reverseProgram;
+		this->classes = toEqual.classes;
+		this->groups = toEqual.groups;
+		this->hasFirstBytes = toEqual.hasFirstBytes;
+		this->firstBytes = toEqual.firstBytes;
+		this->onlyFirstByte = toEqual.onlyFirstByte;
+		this->literal = toEqual.literal;
+
+		// The cached states belong to the old pattern
+		std::lock_guard<std::mutex> lock(this->pool->lock);
+		this->pool->scratches.clear();
+	}
+
+	return *this;
+}
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+bool Regex::search(const StringView& text, size_t fromIdx, Scratch& scratch,
+				   Match& match) const
+{
+	// A pattern of nothing but literal characters is searched for directly
+	if (!this->literal.empty())
+	{
+		const size_t found = text.indexOf(
+				StringView(this->literal.data(), this->literal.length()),
+				fromIdx);
+		if (found == StringView::npos) return false;
+
+		match.positions.resize(2);
+		match.positions[0] = found;
+		match.positions[1] = found + this->literal.length();
+		return true;
+	}
+
+	size_t start;
+	size_t end;
+
+	// Finds where the match begins and ends, either through the cached
+	// states or else by running the threads while only keeping track of
+	// group 0, which makes every thread cheaper to copy
+	bool failed = !scratch.useDfa;
+	if (!failed)
+	{
+		if (!this->searchDfa(text, fromIdx, scratch, start, end, failed) &&
+			!failed)
+		{
+			return false;
+		}
+	}
+	if (failed)
+	{
+		if (scratch.useDfa) scratch.dfaFailed();
+
+		if (!this->run(text, fromIdx, text.length(), SEARCH,
+					   scratch.boundsCurrent, scratch.boundsNext, match))
+		{
+			return false;
+		}
+
+		start = match.start();
+		end = match.end();
+	}
+
+	if (this->groups == 0)
+	{
+		match.positions.resize(2);
+		match.positions[0] = start;
+		match.positions[1] = end;
+		return true;
+	}
+
+	// Only the matched stretch of the text is run again to fill in the
+	// capture groups. Starting from the same place, the paths have the same
+	// priorities and so arrive at the same match.
+	if (this->program.size() * (end - start + 1) <= MAX_BACKTRACK_PATHS)
+	{
+		return this->backtrack(text, start, end, scratch, match);
+	}
+
+	return this->run(text, start, end, PREFIX,
+					 scratch.current, scratch.next, match);
+}
+
+bool Regex::searchDfa(const StringView& text, size_t fromIdx,
+					  Scratch& scratch, size_t& start, size_t& end,
+					  bool& failed) const
+{
+	const size_t length = text.length();
+	Dfa& forward = scratch.forward;
+
+	const int initial = forward.start();
+	if (initial == Dfa::FAILED)
+	{
+		forward.clear();
+		failed = true;
+		return false;
+	}
+
+	// Reads forward until the first match can no longer be extended
+	int state = initial;
+	end = forward.isMatching(state) ? fromIdx : npos;
+	for (size_t idx = fromIdx; idx < length && !forward.isDead(state); idx++)
+	{
+		// With nothing in progress, skips every location where a match
+		// cannot begin
+		if (state == initial && this->hasFirstBytes)
+		{
+			while (idx < length && !this->firstBytes[
+					static_cast<unsigned char>(text[idx])])
+			{
+				++idx;
+			}
+			if (idx == length) break;
+		}
+
+		state = forward.step(state, static_cast<unsigned char>(text[idx]));
+		if (state == Dfa::FAILED)
+		{
+			forward.clear();
+			failed = true;
+			return false;
+		}
+
+		if (forward.isMatching(state)) end = idx + 1;
+	}
+
+	if (end == npos) return false;
+
+	// Reads backward from the end, where the earliest location at which the
+	// reversed pattern matches is the beginning of the match
+	Dfa& reverse = scratch.reverse;
+	state = reverse.start();
+	start = reverse.isMatching(state) ? end : npos;
+	for (size_t idx = end; idx > fromIdx && state != Dfa::FAILED &&
+						   !reverse.isDead(state); idx--)
+	{
+		state = reverse.step(state,
+							 static_cast<unsigned char>(text[idx - 1]));
+		if (state != Dfa::FAILED && reverse.isMatching(state))
+		{
+			start = idx - 1;
+		}
+	}
+
+	if (state == Dfa::FAILED || start == npos)
+	{
+		if (state == Dfa::FAILED) reverse.clear();
+
+		failed = true;
+		return false;
+	}
+
+	return true;
+}
+
+bool Regex::matchesDfa(const StringView& text, Scratch& scratch,
+					   bool& failed) const
+{
+	const size_t length = text.length();
+	Dfa& anchored = scratch.anchored;
+
+	// Reads the whole text, stopping early once no thread is left
+	int state = anchored.start();
+	for (size_t idx = 0; idx < length && state != Dfa::FAILED &&
+						 !anchored.isDead(state); idx++)
+	{
+		state = anchored.step(state, static_cast<unsigned char>(text[idx]));
+	}
+
+	if (state == Dfa::FAILED)
+	{
+		anchored.clear();
+		failed = true;
+		return false;
+	}
+
+	return anchored.isMatching(state);
+}
+
+bool Regex::backtrack(const StringView& text, size_t start, size_t end,
+					  Scratch& scratch, Match& match) const
+{
+	const size_t slots = (this->groups + 1) * 2;
+	const size_t span = end - start + 1;
+
+	std::vector<unsigned int>& visited = scratch.visited;
+	visited.assign((this->program.size() * span + 31) / 32, 0);
+	scratch.captures.assign(slots, npos);
+	size_t* captures = &scratch.captures[0];
+
+	std::vector<Scratch::Job>& jobs = scratch.jobs;
+	jobs.clear();
+
+	const Scratch::Job first = { 0, start, npos };
+	jobs.push_back(first);
+
+	while (!jobs.empty())
+	{
+		const Scratch::Job job = jobs.back();
+		jobs.pop_back();
+
+		if (job.slot != npos)
+		{
+			captures[job.slot] = job.idx;
+			continue;
+		}
+
+		// Follows the path until it fails, only setting aside the lower
+		// priority branch at each SPLIT to be tried afterwards
+		size_t pc = job.pc;
+		size_t idx = job.idx;
+		for (;;)
+		{
+			const size_t bit = pc * span + (idx - start);
+			if (visited[bit / 32] & (1u << (bit % 32))) break;
+			visited[bit / 32] |= 1u << (bit % 32);
+
+			const Instruction& instruction = this->program[pc];
+			const unsigned char c = idx < end ? text[idx] : 0;
+
+			bool next = false;
+			switch (instruction.op)
+			{
+			case CHAR:
+				next = idx < end && c == instruction.c;
+				break;
+			case ANY:
+				next = idx < end && c != '\n';
+				break;
+			case CLASS:
+				next = idx < end && this->classes[instruction.x][c];
+				break;
+			case SPLIT:
+			{
+				const Scratch::Job branch = { instruction.y, idx, npos };
+				jobs.push_back(branch);
+				pc = instruction.x;
+				continue;
+			}
+			case JUMP:
+				pc = instruction.x;
+				continue;
+			case SAVE:
+			{
+				if (instruction.x < slots)
+				{
+					const Scratch::Job restore = {
+						0, captures[instruction.x], instruction.x
+					};
+					jobs.push_back(restore);
+					captures[instruction.x] = idx;
+				}
+				++pc;
+				continue;
+			}
+			case ASSERT:
+				if (!holds(instruction.x, text, idx)) break;
+				++pc;
+				continue;
+			case MATCH:
+				match.positions.assign(captures, captures + slots);
+				return true;
+			}
+
+			if (!next) break;
+			++pc;
+			++idx;
+		}
+	}
+
+	return false;
+}
+
+bool Regex::run(const StringView& text, size_t fromIdx, size_t lastIdx,
+				Mode mode, ThreadList& current, ThreadList& next,
+				Match& match) const
+{
+	const size_t length = text.length();
+	const size_t slots = current.slots;
+
+	bool matched = false;
+	current.clear();
+	for (size_t idx = fromIdx; ; idx++)
+	{
+		// Starts a new thread at this location, which has a lower priority
+		// than every thread started earlier
+		if (!matched && (mode == SEARCH || idx == fromIdx))
+		{
+			if (current.pcs.empty() && this->hasFirstBytes && mode == SEARCH)
+			{
+				// With nothing in progress, skips every location where a
+				// match cannot begin
+				// When only one character can begin a match, memchr finds
+				// it fastest
+				if (this->onlyFirstByte != -1) {
+					const void* found = std::memchr(text.data() + idx,
+													this->onlyFirstByte,
+													length - idx);
+					if (found == NULL) break;
+					idx = static_cast<const char*>(found) - text.data();
+				} else {
+					while (idx < length && !this->firstBytes[
+							static_cast<unsigned char>(text[idx])])
+					{
+						++idx;
+					}
+					if (idx == length) break;
+				}
+			}
+
+			std::vector<size_t>& seed = current.seed;
+			std::fill(seed.begin(), seed.end(), npos);
+			this->addThread(current, 0, &seed[0], text, idx);
+		}
+
+		// With no threads left, only a thread started at a later location can
+		// still match, such as when an assertion failed at this one
+		if (current.pcs.empty() && (matched || mode != SEARCH)) break;
+
+		next.clear();
+		const bool more = idx < length;
+		const unsigned char c = more ? text[idx] : 0;
+
+		for (size_t thread = 0; thread < current.pcs.size(); thread++)
+		{
+			const size_t pc = current.pcs[thread];
+			const Instruction& instruction = this->program[pc];
+			size_t* captures = &current.captures[pc * slots];
+
+			bool consumed = false;
+			bool reported = false;
+			switch (instruction.op)
+			{
+			case CHAR:
+				consumed = more && c == instruction.c;
+				break;
+			case ANY:
+				consumed = more && c != '\n';
+				break;
+			case CLASS:
+				consumed = more && this->classes[instruction.x][c];
+				break;
+			case MATCH:
+				// A whole match must use up the whole text
+				reported = mode != WHOLE || !more;
+				break;
+			default:
+				break;
+			}
+
+			if (consumed)
+			{
+				this->addThread(next, pc + 1, captures, text, idx + 1);
+			}
+
+			// Threads after a match have a lower priority, so they are dropped
+			if (reported)
+			{
+				match.positions.assign(captures, captures + slots);
+				matched = true;
+				break;
+			}
+		}
+
+		std::swap(current, next);
+		if (idx >= lastIdx) break;
+	}
+
+	return matched;
+}
+
+void Regex::addThread(ThreadList& list, size_t pc, size_t* captures,
+					  const StringView& text, size_t idx) const
+{
+	if (list.onList[pc] == list.generation) return;
+	list.onList[pc] = list.generation;
+
+	const Instruction& instruction = this->program[pc];
+	switch (instruction.op)
+	{
+	case JUMP:
+		this->addThread(list, instruction.x, captures, text, idx);
+		break;
+	case SPLIT:
+		this->addThread(list, instruction.x, captures, text, idx);
+		this->addThread(list, instruction.y, captures, text, idx);
+		break;
+	case SAVE:
+	{
+		// Slots beyond those the list keeps track of are not needed
+		if (instruction.x >= list.slots)
+		{
+			this->addThread(list, pc + 1, captures, text, idx);
+			break;
+		}
+
+		// The slot is only changed for the threads reached from here
+		const size_t previous = captures[instruction.x];
+		captures[instruction.x] = idx;
+		this->addThread(list, pc + 1, captures, text, idx);
+		captures[instruction.x] = previous;
+		break;
+	}
+	case ASSERT:
+		if (holds(instruction.x, text, idx))
+		{
+			this->addThread(list, pc + 1, captures, text, idx);
+		}
+		break;
+	default:
+		list.pcs.push_back(pc);
+		std::copy(captures, captures + list.slots,
+				  &list.captures[pc * list.slots]);
+		break;
+	}
+}
+
+bool Regex::holds(size_t assertion, const StringView& text, size_t idx)
+{
+	if (assertion == TEXT_START) return idx == 0;
+	if (assertion == TEXT_END) return idx == text.length();
+
+	const bool before = idx > 0 &&
+			isWordChar(static_cast<unsigned char>(text[idx - 1]));
+	const bool after = idx < text.length() &&
+			isWordChar(static_cast<unsigned char>(text[idx]));
+	return (before != after) == (assertion == WORD_BOUNDARY);
+}
+
+void Regex::computeFirstBytes()
+{
+	// Follows every path from the start of the program up to its first
+	// consuming instruction. Assertions are passed straight through, which
+	// can only ever add characters to the set.
+	std::vector<bool> visited(this->program.size(), false);
+	std::vector<size_t> pending(1, 0);
+	std::bitset<256> first;
+
+	while (!pending.empty())
+	{
+		const size_t pc = pending.back();
+		pending.pop_back();
+		if (visited[pc]) continue;
+		visited[pc] = true;
+
+		const Instruction& instruction = this->program[pc];
+		switch (instruction.op)
+		{
+		case CHAR:
+			first.set(instruction.c);
+			break;
+		case ANY:
+			first.set();
+			first.reset('\n');
+			break;
+		case CLASS:
+			first |= this->classes[instruction.x];
+			break;
+		case SPLIT:
+			pending.push_back(instruction.y);
+			pending.push_back(instruction.x);
+			break;
+		case JUMP:
+			pending.push_back(instruction.x);
+			break;
+		case SAVE:
+		case ASSERT:
+			pending.push_back(pc + 1);
+			break;
+		case MATCH:
+			// The pattern can match nothing at all, so any location works
+			return;
+		}
+	}
+
+	this->firstBytes = first;
+	this->hasFirstBytes = !first.all();
+
+	if (first.count() == 1)
+	{
+		for (int c = 0; c < 256; c++)
+		{
+			if (first[c]) this->onlyFirstByte = c;
+		}
+	}
+}
+
+void Regex::computeLiteral()
+{
+	// A literal pattern compiles to the SAVE for the start of group 0, one
+	// CHAR for each character, and then the SAVE for its end and MATCH
+	if (this->groups != 0 || this->program.size() < 4) return;
+
+	std::string chars;
+	for (size_t pc = 1; pc + 2 < this->program.size(); pc++)
+	{
+		if (this->program[pc].op != CHAR) return;
+
+		chars += static_cast<char>(this->program[pc].c);
+	}
+
+	this->literal = chars;
+}
@@ -0,0 +1,328 @@
+
+#ifndef REGEX_H_
+#define REGEX_H_
+
+#include "StringView.h"
+
+#include <bitset>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class String;
+
+/**
+ * This class stores a compiled regular expression. A pattern is compiled once
+ * when the Regex is created and can then be matched against any number of
+ * Strings.
+ *
+ * Matching runs every possible path through the pattern side by side, so it
+ * takes time proportional to the length of the text times the size of the
+ * pattern and never backtracks. For patterns without ^, $, \b or \B, the
+ * combinations of paths are cached as they are found while searching, so
+ * most characters take a single table lookup. The cache is kept with the
+ * Regex and shared by every later search, so a Regex should be compiled once
+ * and reused rather than created for each search.
+ *
+ * When several matches are possible, the one a backtracking engine such as
+ * std::regex would find first is reported. The one exception is a group
+ * repeated by a quantifier which is also able to match nothing, such as
+ * (a*)*. std::regex stops repeating such a group once an iteration matches
+ * nothing, whereas this engine may go on to a longer one, so the match itself
+ * may differ as well as the captured text. For example, .([^a]*?|aa?)+ finds
+ * " b" at the start of " b c", where std::regex finds only " ".
+ *
+ * A Regex may be used by several threads at once. Each search borrows its
+ * own set of cached states, so searches never wait on one another.
+ *
+ * Supported syntax:
+ * - Literal characters, and '.' for any character other than a newline
+ * - Character classes such as [abc], [a-z] and [^0-9]; a ']' straight after
+ *   the opening bracket is part of the class
+ * - \d, \w, \s and their negations \D, \W, \S
+ * - \t, \n, \r, \f, \v, \0 and escaped punctuation such as \. or \(
+ * - ^ and $, which match the beginning and end of the text
+ * - \b and \B, which match at (or away from) a word boundary
+ * - Capture groups (...) and non-capturing groups (?:...)
+ * - Alternation a|b
+ * - Quantifiers *, +, ?, {n}, {n,} and {n,m}, each followed by an optional ?
+ *   to prefer the fewest repetitions
+ *
+ * Backreferences within a pattern are not supported.
+ *
+ * @example
+ * Regex date("(\\d{4})-(\\d{2})-(\\d{2})");
+ * String("Due 2015-04-01").find(date).start(1); // Returns 4
+ */
+class Regex
+{
+
+public:
+
+	/**
+	 * Returned by Match::start and Match::end for a group which did not take
+	 * part in the match.
+	 */
+	static const size_t npos = static_cast<size_t>(-1);
+
+	/**
+	 * Describes where a Regex matched within some text. Group 0 is the whole
+	 * match while groups 1 and up are the capture groups, numbered by the
+	 * position of their opening parenthesis.
+	 *
+	 * @example
+	 * Regex::Match m = s.find(regex);
+	 * if (m.found()) s.substring(m.start(1), m.end(1)); // The first group
+	 */
+	class Match
+	{
+
+	public:
+
+		/**
+		 * Creates a Match which did not find anything.
+		 */
+		Match();
+
+		/**
+		 * @return Whether the Regex was found
+		 */
+		const bool found() const;
+
+		/**
+		 * @return The number of groups including group 0
+		 */
+		const size_t groupCount() const;
+
+		/**
+		 * @param group The group being examined
+		 * @return The index location of the group's first character;
+		 * 		   Will return npos if the group did not take part
+		 */
+		const size_t start(size_t group = 0) const;
+
+		/**
+		 * @param group The group being examined
+		 * @return The index location AFTER the group's last character;
+		 * 		   Will return npos if the group did not take part
+		 */
+		const size_t end(size_t group = 0) const;
+
+	private:
+		friend class Regex;
+
+		// The start and end of each group, one after the other
+		std::vector<size_t> positions;
+
+	};
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Compiles the given pattern.
+	 *
+	 * @param pattern The regular expression to be compiled
+	 * @throws std::invalid_argument If the pattern is not well formed
+	 */
+	explicit Regex(const String& pattern);
+
+	/**
+	 * Copies the compiled pattern. The cached states are not copied and are
+	 * built up again as the copy is used.
+	 */
+	Regex(const Regex& toCopy);
+
+	~Regex();
+
+// -----------------------------------------------------------------------------
+// Regex Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The pattern this Regex was compiled from
+	 */
+	const std::string& pattern() const;
+
+	/**
+	 * @return The number of capture groups, not including group 0
+	 */
+	const size_t groupCount() const;
+
+// -----------------------------------------------------------------------------
+// Matching
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @param text The text to be matched
+	 * @return Whether the whole of the text matches this Regex
+	 */
+	const bool matches(const StringView& text) const;
+
+	/**
+	 * Finds the first match at or after the given index location.
+	 *
+	 * @param text The text to be searched
+	 * @param fromIdx The index location where the search begins
+	 * @return The match; Match::found returns false if nothing was found
+	 */
+	const Match find(const StringView& text, size_t fromIdx = 0) const;
+
+	/**
+	 * Finds every match which does not overlap an earlier one, from left to
+	 * right. After an empty match the search continues one character later.
+	 *
+	 * @param text The text to be searched
+	 * @return Each match in order
+	 */
+	std::vector<Match> findAll(const StringView& text) const;
+
+// -----------------------------------------------------------------------------
+// Operators
+// -----------------------------------------------------------------------------
+
+	Regex& operator=(const Regex& toEqual);
+
+private:
+
+	enum Opcode
+	{
+		CHAR,   // Consumes the character c
+		ANY,    // Consumes any character other than a newline
+		CLASS,  // Consumes any character in classes[x]
+		SPLIT,  // Continues at both x and y, preferring x
+		JUMP,   // Continues at x
+		SAVE,   // Records the current index location in capture slot x
+		ASSERT, // Continues only if the assertion x holds here
+		MATCH   // Reports a match
+	};
+
+	enum Assertion
+	{
+		TEXT_START,
+		TEXT_END,
+		WORD_BOUNDARY,
+		NOT_WORD_BOUNDARY
+	};
+
+	struct Instruction
+	{
+		Opcode op;
+		unsigned char c;
+		size_t x;
+		size_t y;
+	};
+
+	enum Mode
+	{
+		SEARCH, // The match may begin anywhere from fromIdx onwards
+		PREFIX, // The match must begin at fromIdx
+		WHOLE   // The match must begin at fromIdx and use up the whole text
+	};
+
+	struct ThreadList;
+	struct Dfa;
+	struct Scratch;
+	struct ScratchPool;
+	class ScratchLease;
+	friend class RegexCompiler;
+
+	/**
+	 * Finds the first match at or after the given index location along with
+	 * all of its capture groups.
+	 *
+	 * @return Whether a match was found
+	 */
+	bool search(const StringView& text, size_t fromIdx, Scratch& scratch,
+				Match& match) const;
+
+	/**
+	 * Finds where the first match at or after the given index location
+	 * begins and ends using the cached states.
+	 *
+	 * @param failed Set to true if the cached states could not be used
+	 * @return Whether a match was found
+	 */
+	bool searchDfa(const StringView& text, size_t fromIdx, Scratch& scratch,
+				   size_t& start, size_t& end, bool& failed) const;
+
+	/**
+	 * Checks whether the whole of the text matches using the cached states.
+	 *
+	 * @param failed Set to true if the cached states could not be used
+	 * @return Whether the text matched
+	 */
+	bool matchesDfa(const StringView& text, Scratch& scratch,
+					bool& failed) const;
+
+	/**
+	 * Fills in the capture groups of a match already known to span start to
+	 * end by trying each path through the program in order of priority,
+	 * never trying a path from the same instruction and index location
+	 * twice.
+	 *
+	 * @return Whether a match was found
+	 */
+	bool backtrack(const StringView& text, size_t start, size_t end,
+				   Scratch& scratch, Match& match) const;
+
+	/**
+	 * Runs the program over the text from fromIdx up to lastIdx, keeping
+	 * track of as many capture slots as the thread lists have room for.
+	 *
+	 * @return Whether a match was found
+	 */
+	bool run(const StringView& text, size_t fromIdx, size_t lastIdx,
+			 Mode mode, ThreadList& current, ThreadList& next,
+			 Match& match) const;
+
+	/**
+	 * Adds the thread at pc, along with every thread reachable from it
+	 * without consuming a character, to the given list.
+	 */
+	void addThread(ThreadList& list, size_t pc, size_t* captures,
+				   const StringView& text, size_t idx) const;
+
+	/**
+	 * @param assertion One of the Assertion values
+	 * @return Whether the assertion holds at the index location
+	 */
+	static bool holds(size_t assertion, const StringView& text, size_t idx);
+
+	/**
+	 * Works out which characters a match can begin with, so that searching
+	 * can skip straight past any others.
+	 */
+	void computeFirstBytes();
+
+	/**
+	 * Works out whether the pattern is nothing but literal characters, which
+	 * are then searched for directly without running the program.
+	 */
+	void computeLiteral();
+
+	std::string source;                        // The original pattern
+	std::vector<Instruction> program;          // The compiled pattern
+	std::vector<Instruction> reverseProgram;   // Empty if there are assertions
+	std::vector<std::bitset<256> > classes;    // Used by CLASS instructions
+	size_t groups;                             // Capture groups, without 0
+
+	bool hasFirstBytes;              // Whether firstBytes may be relied upon
+	std::bitset<256> firstBytes;     // Characters a match can begin with
+	int onlyFirstByte;               // The one character a match can begin
+									 // with, or -1 if there may be more
+	std::string literal;             // The characters matched, if the pattern
+									 // is nothing but literal characters
+
+	// The Scratches not in use by any search. A search takes one out and puts
+	// it back when done, so each Scratch's cached states are only ever used
+	// by one thread at a time. It is kept out of this header so that String.h
+	// still compiles as C++98.
+	ScratchPool* pool;
+
+};
+
+
+
+#endif
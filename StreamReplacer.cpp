@@ -0,0 +1,75 @@
+
+#include "StreamReplacer.h"
+
+#include <algorithm>
+
+StreamReplacer::StreamReplacer(const StringView& segment,
+							   const StringView& replacement,
+							   std::ostream& sink)
+	: searcher(segment), replacement(replacement.data(), replacement.length()),
+	  sink(&sink), replaced(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Replacer Information
+// -----------------------------------------------------------------------------
+
+const unsigned long long StreamReplacer::replacements() const
+{
+	return this->replaced;
+}
+
+// -----------------------------------------------------------------------------
+// Replacing
+// -----------------------------------------------------------------------------
+
+void StreamReplacer::feed(const StringView& chunk)
+{
+	const char* segment = this->searcher.segment().data();
+	const size_t segmentLength = this->searcher.segment().length();
+
+	// The characters held back from earlier chunks, which are always the
+	// first characters of the segment and so are not stored anywhere else
+	size_t held = this->searcher.partialMatch();
+	size_t written = 0; // The index location of the first unwritten character
+
+	size_t end = 0;
+	while ((end = this->searcher.feedUntilMatch(chunk, end)) !=
+		   StringView::npos)
+	{
+		// Writes everything before the match, which may have begun in the
+		// held back characters
+		if (end >= segmentLength)
+		{
+			this->sink->write(segment, held);
+			this->sink->write(chunk.data() + written,
+							  end - segmentLength - written);
+		}
+		else
+		{
+			this->sink->write(segment, held - (segmentLength - end));
+		}
+
+		this->sink->write(this->replacement.data(), this->replacement.length());
+		++this->replaced;
+
+		held = 0;
+		written = end;
+	}
+
+	// Holds back only the characters which might begin the next match
+	const size_t kept = this->searcher.partialMatch();
+	const size_t flushed = held + (chunk.length() - written) - kept;
+	const size_t flushedHeld = std::min(held, flushed);
+
+	this->sink->write(segment, flushedHeld);
+	this->sink->write(chunk.data() + written, flushed - flushedHeld);
+}
+
+void StreamReplacer::finish()
+{
+	this->sink->write(this->searcher.segment().data(),
+					  this->searcher.partialMatch());
+	this->searcher.reset();
+}
@@ -0,0 +1,87 @@
+
+#ifndef STREAMREPLACER_H_
+#define STREAMREPLACER_H_
+
+#include "StreamSearcher.h"
+#include "StringView.h"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+/**
+ * This class replaces every occurrence of a segment within text which arrives
+ * a chunk at a time, writing the result to an output stream as it goes. Only
+ * the characters which might still turn out to be the beginning of a match are
+ * held back, and those are always the first characters of the segment, so the
+ * memory used does not grow with the length of the text.
+ *
+ * Matches are replaced from left to right without overlapping, the same as
+ * String::replaceAll.
+ *
+ * @example
+ * StreamReplacer replacer("cat", "dog", std::cout);
+ * replacer.feed("the c");
+ * replacer.feed("at sat"); // Writes [the dog sat]
+ * replacer.finish();
+ */
+class StreamReplacer
+{
+
+public:
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates a StreamReplacer which has not been fed anything yet.
+	 *
+	 * @param segment The segment to be replaced; It is copied
+	 * @param replacement What each occurrence is replaced with; It is copied
+	 * @param sink The stream the result is written to. It must outlive this
+	 * 			   StreamReplacer.
+	 */
+	StreamReplacer(const StringView& segment, const StringView& replacement,
+				   std::ostream& sink);
+
+// -----------------------------------------------------------------------------
+// Replacer Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The number of occurrences replaced so far
+	 */
+	const unsigned long long replacements() const;
+
+// -----------------------------------------------------------------------------
+// Replacing
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Writes the next chunk of the text with every occurrence replaced, apart
+	 * from any characters at its end which might begin an occurrence.
+	 *
+	 * @param chunk The characters which follow everything fed so far
+	 */
+	void feed(const StringView& chunk);
+
+	/**
+	 * Writes any characters still being held back, as the text has ended
+	 * without completing an occurrence. The StreamReplacer may then be fed a
+	 * new text.
+	 */
+	void finish();
+
+private:
+
+	StreamSearcher searcher;
+	std::string replacement;
+	std::ostream* sink;
+	unsigned long long replaced;
+
+};
+
+
+
+#endif
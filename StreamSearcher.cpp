@@ -0,0 +1,125 @@
+
+#include "StreamSearcher.h"
+
+#include <cstring>
+
+StreamSearcher::StreamSearcher(const StringView& segment)
+	: pattern(segment.data(), segment.length()),
+	  fallback(segment.length() + 1, 0), matched(0), fed(0)
+{
+	// fallback[k] is the length of the longest proper prefix of the first k
+	// characters of the segment which is also a suffix of them, which is how
+	// much of a partial match of length k survives a mismatch
+	size_t border = 0;
+	for (size_t idx = 1; idx < this->pattern.length(); idx++)
+	{
+		while (border > 0 && this->pattern[idx] != this->pattern[border])
+		{
+			border = this->fallback[border];
+		}
+
+		if (this->pattern[idx] == this->pattern[border]) ++border;
+
+		this->fallback[idx + 1] = border;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Searcher Information
+// -----------------------------------------------------------------------------
+
+const StringView StreamSearcher::segment() const
+{
+	return StringView(this->pattern.data(), this->pattern.length());
+}
+
+const unsigned long long StreamSearcher::position() const
+{
+	return this->fed;
+}
+
+const size_t StreamSearcher::partialMatch() const
+{
+	return this->matched;
+}
+
+// -----------------------------------------------------------------------------
+// Searching
+// -----------------------------------------------------------------------------
+
+std::vector<unsigned long long> StreamSearcher::feed(const StringView& chunk)
+{
+	std::vector<unsigned long long> indexes;
+
+	size_t idx = 0;
+	while ((idx = this->feedUntilMatch(chunk, idx)) != StringView::npos)
+	{
+		indexes.push_back(this->fed - this->pattern.length());
+	}
+
+	return indexes;
+}
+
+const size_t StreamSearcher::feedUntilMatch(const StringView& chunk,
+											size_t fromIdx /* Default of 0 */)
+{
+	const size_t length = chunk.length();
+	const size_t patternLength = this->pattern.length();
+
+	if (fromIdx >= length) return StringView::npos;
+
+	if (patternLength == 0)
+	{
+		this->fed += length - fromIdx;
+		return StringView::npos;
+	}
+
+	const char* chars = chunk.data();
+	const char* segment = this->pattern.data();
+	size_t matched = this->matched;
+
+	size_t idx = fromIdx;
+	while (idx < length)
+	{
+		// With nothing matched yet, skips straight to the next character
+		// which could begin a match
+		if (matched == 0)
+		{
+			const char* next = static_cast<const char*>(
+					std::memchr(chars + idx, segment[0], length - idx));
+			if (next == NULL)
+			{
+				idx = length;
+				break;
+			}
+			idx = next - chars;
+		}
+
+		const char c = chars[idx++];
+		while (matched > 0 && segment[matched] != c)
+		{
+			matched = this->fallback[matched];
+		}
+		if (segment[matched] == c) ++matched;
+
+		if (matched == patternLength)
+		{
+			// Starts over so that matches never overlap
+			this->matched = 0;
+			this->fed += idx - fromIdx;
+
+			return idx;
+		}
+	}
+
+	this->matched = matched;
+	this->fed += idx - fromIdx;
+
+	return StringView::npos;
+}
+
+void StreamSearcher::reset()
+{
+	this->matched = 0;
+	this->fed = 0;
+}
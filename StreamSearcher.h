@@ -0,0 +1,112 @@
+
+#ifndef STREAMSEARCHER_H_
+#define STREAMSEARCHER_H_
+
+#include "StringView.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * This class finds a segment within text which arrives a chunk at a time, such
+ * as from a file or a socket. How much of the segment has been matched so far
+ * is kept between chunks, so a match which is split across two or more chunks
+ * is still found and none of the earlier chunks need to be kept around.
+ *
+ * Matches never overlap, the same as String::indexesOf. Each character is
+ * examined a constant number of times on average no matter how the segment
+ * repeats itself, and while nothing has been matched the search jumps straight
+ * to the next occurrence of the segment's first character.
+ *
+ * @example
+ * StreamSearcher searcher("needle");
+ * searcher.feed("hay nee");
+ * searcher.feed("dle hay"); // Returns [4]
+ */
+class StreamSearcher
+{
+
+public:
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates a StreamSearcher which has not been fed anything yet. An empty
+	 * segment is never found.
+	 *
+	 * @param segment The segment to be searched for; It is copied
+	 */
+	explicit StreamSearcher(const StringView& segment);
+
+// -----------------------------------------------------------------------------
+// Searcher Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The segment being searched for
+	 */
+	const StringView segment() const;
+
+	/**
+	 * @return The total number of characters fed so far
+	 */
+	const unsigned long long position() const;
+
+	/**
+	 * @return How many of the most recently fed characters begin a match which
+	 * 		   has not been completed yet. These characters are always the
+	 * 		   same as the first characters of the segment.
+	 */
+	const size_t partialMatch() const;
+
+// -----------------------------------------------------------------------------
+// Searching
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Searches the next chunk of the text.
+	 *
+	 * @param chunk The characters which follow everything fed so far
+	 * @return The index location of every match completed within this chunk,
+	 * 		   counted from the beginning of the whole text
+	 */
+	std::vector<unsigned long long> feed(const StringView& chunk);
+
+	/**
+	 * Feeds the chunk from the given index location only up to the end of the
+	 * next match. Calling this again from the returned index location carries
+	 * on where it left off, which lets a caller act on each match as soon as
+	 * it is found.
+	 *
+	 * @param chunk The characters which follow everything fed so far
+	 * @param fromIdx The index location of the first character not yet fed
+	 * @return The index location in the chunk AFTER the match's last
+	 * 		   character; Will return StringView::npos if the rest of the
+	 * 		   chunk was fed without completing a match
+	 */
+	const size_t feedUntilMatch(const StringView& chunk, size_t fromIdx = 0);
+
+	/**
+	 * Forgets everything fed so far, so that the next chunk is treated as the
+	 * beginning of a new text.
+	 */
+	void reset();
+
+private:
+
+	std::string pattern;           // The segment being searched for
+	std::vector<size_t> fallback;  // The partial match to resume from when
+								   // the next character of the segment does
+								   // not match, indexed by the current
+								   // partial match
+	size_t matched;                // The current partial match
+	unsigned long long fed;        // The number of characters fed so far
+
+};
+
+
+
+#endif
@@ -1,35 +1,451 @@
 
 #include "String.h"
+#include "StringBuilder.h"
+#include "StringProfiling.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <mutex>
 #include <sstream>
 #include <vector>
 #include <stdexcept>
 
-String::String(const char* c_str /* Default of '\0' */)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Everything the UTF-8 methods have learned about a String so far.
+ */
+struct String::Utf8Cache
+{
+	enum Validity { UNKNOWN, VALID, INVALID };
+
+	Utf8Cache() : validity(UNKNOWN), counted(false), codePoints(0) {}
+
+	Validity validity;
+	bool counted;            // Whether codePoints has been calculated
+	unsigned int codePoints; // The number of code points in the String
+
+	// The byte location of every 16th code point; empty until
+	// buildCodePointIndex is called
+	std::vector<unsigned int> checkpoints;
+};
+
+// The number of code points between each entry of Utf8Cache::checkpoints
+static const size_t CODE_POINTS_PER_CHECKPOINT = 16;
+
+// The number of locks the UTF-8 caches of every String are divided between
+static const size_t UTF8_LOCK_COUNT = 64;
+
+/**
+ * @return The lock guarding the UTF-8 cache of the String at the given
+ * 		   address. Strings share locks so that none has to carry its own.
+ */
+static std::mutex& utf8Lock(const void* string)
+{
+	static std::mutex locks[UTF8_LOCK_COUNT];
+
+	// The lowest bits are the same for every String, so they are dropped
+	const uintptr_t address = reinterpret_cast<uintptr_t>(string);
+	return locks[(address / sizeof(void*)) % UTF8_LOCK_COUNT];
+}
+
+// Stands in for any byte which does not begin a valid UTF-8 sequence
+static const unsigned int REPLACEMENT_CHARACTER = 0xFFFD;
+
+/**
+ * Returns how many of the given bytes are ASCII before the first byte which
+ * is not. Sixteen bytes are checked at a time where SSE2 is available and
+ * eight at a time otherwise.
+ */
+static size_t countAsciiPrefix(const unsigned char* bytes, size_t length)
+{
+	size_t idx = 0;
+
+#if defined(__SSE2__)
+	for (; idx + 16 <= length; idx += 16)
+	{
+		// Collects the high bit of all sixteen bytes at once
+		__m128i chunk = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(bytes + idx));
+		if (_mm_movemask_epi8(chunk) != 0) break;
+	}
+#else
+	for (; idx + 8 <= length; idx += 8)
+	{
+		unsigned long long chunk;
+		std::memcpy(&chunk, bytes + idx, sizeof(chunk));
+		if ((chunk & 0x8080808080808080ULL) != 0) break;
+	}
+#endif
+
+	while (idx < length && bytes[idx] < 0x80) ++idx;
+
+	return idx;
+}
+
+/**
+ * Decodes the UTF-8 sequence beginning at the given byte.
+ *
+ * @return The number of bytes in the sequence, or 0 if the bytes do not form
+ * 		   a valid sequence
+ */
+static size_t decodeUtf8(const unsigned char* bytes, const unsigned char* end,
+						 unsigned int& codePoint)
+{
+	const unsigned char lead = bytes[0];
+	if (lead < 0x80)
+	{
+		codePoint = lead;
+		return 1;
+	}
+
+	// Determines the sequence length along with the range allowed for the
+	// second byte, which rules out overlong encodings, surrogates and code
+	// points above U+10FFFF
+	size_t length;
+	unsigned char low = 0x80;
+	unsigned char high = 0xBF;
+	if (lead >= 0xC2 && lead <= 0xDF) {
+		length = 2;
+		codePoint = lead & 0x1F;
+	} else if (lead >= 0xE0 && lead <= 0xEF) {
+		length = 3;
+		codePoint = lead & 0x0F;
+		if (lead == 0xE0) low = 0xA0;
+		if (lead == 0xED) high = 0x9F;
+	} else if (lead >= 0xF0 && lead <= 0xF4) {
+		length = 4;
+		codePoint = lead & 0x07;
+		if (lead == 0xF0) low = 0x90;
+		if (lead == 0xF4) high = 0x8F;
+	} else {
+		return 0;
+	}
+
+	if (end - bytes < static_cast<long>(length)) return 0;
+	if (bytes[1] < low || bytes[1] > high) return 0;
+
+	for (size_t idx = 1; idx < length; idx++)
+	{
+		if ((bytes[idx] & 0xC0) != 0x80) return 0;
+		codePoint = (codePoint << 6) | (bytes[idx] & 0x3F);
+	}
+
+	return length;
+}
+
+/**
+ * @return The number of bytes taken up by the code point beginning at the
+ * 		   given byte, treating an invalid byte as a code point of its own
+ */
+static size_t codePointWidth(const unsigned char* bytes,
+							 const unsigned char* end)
+{
+	unsigned int codePoint;
+	size_t width = decodeUtf8(bytes, end, codePoint);
+
+	return width == 0 ? 1 : width;
+}
+
+/**
+ * Appends the replacement for the given match, filling in any $n references
+ * to its capture groups.
+ */
+static void appendReplacement(StringBuilder& builder, const StringView& text,
+							  const Regex::Match& match,
+							  const StringView& replacement)
+{
+	for (size_t idx = 0; idx < replacement.length(); idx++)
+	{
+		const char c = replacement[idx];
+		const char after = idx + 1 < replacement.length()
+						   ? replacement[idx + 1] : '\0';
+
+		if (c == '$' && after == '$') {
+			builder.append('$');
+			++idx;
+		} else if (c == '$' && after >= '0' && after <= '9') {
+			const size_t group = after - '0';
+			if (match.start(group) != Regex::npos)
+			{
+				builder.append(text.subview(match.start(group),
+											match.end(group)));
+			}
+			++idx;
+		} else {
+			builder.append(c);
+		}
+	}
+}
+
+// Each of the structs below describes which bytes one of the escape methods
+// has to replace. needsEscape is given either a single byte or, where SSE2 is
+// available, sixteen bytes at once, in which case every byte which must be
+// replaced is set to 0xFF in the result.
+
+struct JsonEscaping
+{
+	static bool needsEscape(unsigned char c)
+	{
+		return c < 0x20 || c == '"' || c == '\\';
+	}
+
+#if defined(__SSE2__)
+	static __m128i needsEscape(__m128i block)
+	{
+		// Subtracting 0x1F leaves zero only for the control characters
+		__m128i control = _mm_cmpeq_epi8(
+				_mm_subs_epu8(block, _mm_set1_epi8(0x1F)), _mm_setzero_si128());
+
+		return _mm_or_si128(control, _mm_or_si128(
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('\\'))));
+	}
+#endif
+};
+
+struct CsvEscaping
+{
+	static bool needsEscape(unsigned char c)
+	{
+		return c == ',' || c == '"' || c == '\r' || c == '\n';
+	}
+
+#if defined(__SSE2__)
+	static __m128i needsEscape(__m128i block)
+	{
+		return _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(',')),
+							 _mm_cmpeq_epi8(block, _mm_set1_epi8('"'))),
+				_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')),
+							 _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))));
+	}
+#endif
+};
+
+struct UrlEscaping
 {
+	// Everything other than the unreserved characters of RFC 3986
+	static bool needsEscape(unsigned char c)
+	{
+		return !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+				 (c >= '0' && c <= '9') ||
+				 c == '-' || c == '.' || c == '_' || c == '~');
+	}
+
+#if defined(__SSE2__)
+	/**
+	 * Sets each byte which lies between low and high inclusive to 0xFF.
+	 */
+	static __m128i inRange(__m128i block, char low, char high)
+	{
+		// A byte is left unchanged by max with low only if it is at least low,
+		// and by min with high only if it is at most high
+		__m128i atLeastLow = _mm_max_epu8(block, _mm_set1_epi8(low));
+		__m128i atMostHigh = _mm_min_epu8(block, _mm_set1_epi8(high));
+
+		return _mm_and_si128(_mm_cmpeq_epi8(atLeastLow, block),
+							 _mm_cmpeq_epi8(atMostHigh, block));
+	}
+
+	static __m128i needsEscape(__m128i block)
+	{
+		// Setting the 0x20 bit turns uppercase letters into lowercase ones
+		__m128i folded = _mm_or_si128(block, _mm_set1_epi8(0x20));
+
+		__m128i alphanumeric = _mm_or_si128(inRange(folded, 'a', 'z'),
+											inRange(block, '0', '9'));
+		__m128i symbol = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('-')),
+							 _mm_cmpeq_epi8(block, _mm_set1_epi8('.'))),
+				_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('_')),
+							 _mm_cmpeq_epi8(block, _mm_set1_epi8('~'))));
+
+		return _mm_cmpeq_epi8(_mm_or_si128(alphanumeric, symbol),
+							  _mm_setzero_si128());
+	}
+#endif
+};
+
+struct HtmlEscaping
+{
+	static bool needsEscape(unsigned char c)
+	{
+		return c == '&' || c == '<' || c == '>' || c == '"' || c == '\'';
+	}
+
+#if defined(__SSE2__)
+	static __m128i needsEscape(__m128i block)
+	{
+		__m128i quote = _mm_or_si128(
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('\'')));
+
+		return _mm_or_si128(quote, _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('&')),
+							 _mm_cmpeq_epi8(block, _mm_set1_epi8('<'))),
+				_mm_cmpeq_epi8(block, _mm_set1_epi8('>'))));
+	}
+#endif
+};
+
+/**
+ * Returns the index location of the first byte at or after fromIdx which the
+ * given kind of escaping has to replace, or length if there is none. Sixteen
+ * bytes are checked at a time where SSE2 is available.
+ */
+template <class Escaping>
+static size_t findEscape(const char* chars, size_t fromIdx, size_t length)
+{
+	size_t idx = fromIdx;
+
+#if defined(__SSE2__)
+	for (; idx + 16 <= length; idx += 16)
+	{
+		__m128i block = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(chars + idx));
+		if (_mm_movemask_epi8(Escaping::needsEscape(block)) != 0) break;
+	}
+#endif
+
+	while (idx < length &&
+		   !Escaping::needsEscape(static_cast<unsigned char>(chars[idx])))
+	{
+		++idx;
+	}
+
+	return idx;
+}
+
+/**
+ * @return The value of the given hexadecimal digit, or -1 if it is not one
+ */
+static int hexValue(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+	return -1;
+}
+
+/**
+ * Reads the given number of hexadecimal digits.
+ *
+ * @return Whether every character was a hexadecimal digit
+ */
+static bool parseHex(const char* chars, size_t digits, unsigned int& value)
+{
+	value = 0;
+	for (size_t idx = 0; idx < digits; idx++)
+	{
+		const int digit = hexValue(chars[idx]);
+		if (digit < 0) return false;
+
+		value = value * 16 + digit;
+	}
+
+	return true;
+}
+
+/**
+ * Appends the given code point encoded as UTF-8.
+ */
+static void appendUtf8(StringBuilder& builder, unsigned int codePoint)
+{
+	if (codePoint < 0x80) {
+		builder.append(static_cast<char>(codePoint));
+	} else if (codePoint < 0x800) {
+		builder.append(static_cast<char>(0xC0 | (codePoint >> 6)));
+		builder.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	} else if (codePoint < 0x10000) {
+		builder.append(static_cast<char>(0xE0 | (codePoint >> 12)));
+		builder.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		builder.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	} else {
+		builder.append(static_cast<char>(0xF0 | (codePoint >> 18)));
+		builder.append(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+		builder.append(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		builder.append(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+}
+
+/**
+ * @return The room to reserve for escaping the given number of bytes, which
+ * 		   avoids re-allocating unless escapes are unusually common
+ */
+static size_t escapedCapacity(size_t length)
+{
+	return length + length / 8 + 16;
+}
+
+const unsigned int String::npos;
+
+String::String(const char* c_str /* Default of "" */)
+{
+	STRING_PROFILE("String::String(const char*)");
+
+	this->utf8Cache = NULL;
+
+	const size_t length = std::strlen(c_str);
+
 	// Allocate memory for each character plus the null terminating bit
-	this->c_str = new char[std::strlen(c_str) + 1];
+	this->c_str = new char[length + 1];
+	STRING_COUNT_ALLOC(length + 1);
 
 	// Copies each character over from the given c_str including the null
 	// terminating bit
-	std::strcpy(this->c_str, c_str);
+	std::memcpy(this->c_str, c_str, length + 1);
+	STRING_COUNT_COPY(length);
+}
+
+String::String(const char* chars, size_t count)
+{
+	STRING_PROFILE("String::String(const char*, size_t)");
+
+	this->utf8Cache = NULL;
+
+	// Allocate memory for each character plus the null terminating bit
+	this->c_str = new char[count + 1];
+	STRING_COUNT_ALLOC(count + 1);
+
+	std::memcpy(this->c_str, chars, count);
+	STRING_COUNT_COPY(count);
+	this->c_str[count] = '\0';
+}
+
+String::String(char* buffer, AdoptBuffer)
+	: c_str(buffer), utf8Cache(NULL)
+{
 }
 
 String::String(const String& toCopy)
 {
+	STRING_PROFILE("String::String(const String&)");
+
+	this->utf8Cache = NULL;
+
+	const size_t length = std::strlen(toCopy.c_str);
+
 	// Allocate memory for each character plus the null terminating bit
-	this->c_str = new char[std::strlen(toCopy.c_str) + 1];
+	this->c_str = new char[length + 1];
+	STRING_COUNT_ALLOC(length + 1);
 
 	// Copies each character over from the given c_str including the null
 	// terminating bit
-	std::strcpy(this->c_str, toCopy.c_str);
+	std::memcpy(this->c_str, toCopy.c_str, length + 1);
+	STRING_COUNT_COPY(length);
 }
 
 String::~String()
 {
 	delete [] this->c_str;
 	this->c_str = NULL;
+
+	this->clearUtf8Cache();
 }
 
 // -----------------------------------------------------------------------------
@@ -38,132 +454,63 @@ String::~String()
 
 const unsigned int String::length() const
 {
+	STRING_PROFILE("String::length()");
+
 	return std::strlen(this->c_str);
 }
 
 const char String::charAt(unsigned int idx) const
 {
+	STRING_PROFILE("String::charAt(unsigned int)");
+
 	return this->c_str[idx];
 }
 
 const char String::operator[](unsigned int idx) const
 {
+	STRING_PROFILE("String::operator[](unsigned int)");
+
 	return this->c_str[idx];
 }
 
-const unsigned int String::indexOf(const String& segment) const
+const unsigned int String::indexOf(const StringView& segment) const
 {
-	// Tracks the character being examined starting at the first
-	char* sentry = this->c_str;
-	String compareBuilder(""); // Builds a temporary string for comparing
-	while ( (sentry - this->c_str) < this->length() &&
-		     compareBuilder != segment)
-	{
-		// Compares the sentry's current character of this String with the
-		// character of the given segment. It uses compareBuilder's current
-		// length as an index to determine how far along in the comparison
-		// it has gotten. If the two characters are equal, that character
-		// is appended onto compareBuilder.
-		if (*sentry == segment[compareBuilder.length()])
-		{
-			// Append another character to the builder
-			compareBuilder += *sentry;
+	STRING_PROFILE("String::indexOf(const StringView&)");
 
-			++sentry;
-		} else if (compareBuilder.length() > 0) {
-			compareBuilder = "";
-		} else {
-			++sentry;
-		}
-	}
+	const size_t found = StringView(*this).indexOf(segment);
 
-	// In the case that the segment could not be found, returns -1.
-	if (compareBuilder != segment) return -1;
+	// In the case that the segment could not be found, returns npos (-1).
+	if (found == StringView::npos) return npos;
 
-	// Takes the sentry's location and backs it up to the very first character
-	// where the two comparisons meet. It then has the c_str's memory location
-	// subtract to reveal the relative index location.
-	return (sentry - compareBuilder.length()) - this->c_str;
+	return found;
 }
 
-std::vector<int> String::indexesOf(const String& segment) const
+std::vector<int> String::indexesOf(const StringView& segment) const
 {
+	STRING_PROFILE("String::indexesOf(const StringView&)");
+
 	std::vector<int> indexes;
+	if (segment.length() == 0) return indexes;
 
-	// Handles known cases of equality or inequality
-	if (segment.length() > this->length()) return indexes;
+	const StringView view(*this);
 
-	// Tracks the character being examined starting at the first
-	char* sentry = this->c_str;
-	String compareBuilder(""); // Builds a temporary string for comparing
-	while ((sentry - this->c_str) < this->length())
+	// Continues each search after the end of the previous match so that
+	// matches never overlap
+	size_t found = view.indexOf(segment);
+	while (found != StringView::npos)
 	{
-		// Compares the sentry's current character of this String with the
-		// character of the given segment. It uses compareBuilder's current
-		// length as an index to determine how far along in the comparison
-		// it has gotten. If the two characters are equal, that character
-		// is appended onto compareBuilder.
-		if (*sentry == segment[compareBuilder.length()])
-		{
-			// Append another character to the builder
-			compareBuilder += *sentry;
-
-			// If a full match has been found, store the index location and
-			// reset the comparison builder
-			if (compareBuilder == segment)
-			{
-				indexes.push_back((sentry - compareBuilder.length()) - this->c_str + 1);
-				compareBuilder = "";
-			}
-
-			++sentry;
-		} else if (compareBuilder.length() > 0) {
-			// Sentry must back up all the way to the index directly after the
-			// first index where a potential match was found
-			sentry -= compareBuilder.length() - 1;
-			compareBuilder = "";
-		} else {
-			// Comparison not found, continue to the next character
-			++sentry;
-		}
+		indexes.push_back(found);
+		found = view.indexOf(segment, found + segment.length());
 	}
+
 	return indexes;
 }
 
-const bool String::contains(const String& segment) const
+const bool String::contains(const StringView& segment) const
 {
-	// Handles known cases of equality or inequality
-	if (segment.length() > this->length()) return false;
-	if (segment == *this) return true;
+	STRING_PROFILE("String::contains(const StringView&)");
 
-	// Tracks the character being examined starting at the first
-	char* sentry = this->c_str;
-	String compareBuilder(""); // Builds a temporary string for comparing
-	while ( (sentry - this->c_str) < this->length() &&
-		     compareBuilder != segment)
-	{
-		// Compares the sentry's current character of this String with the
-		// character of the given segment. It uses compareBuilder's current
-		// length as an index to determine how far along in the comparison
-		// it has gotten. If the two characters are equal, that character
-		// is appended onto compareBuilder.
-		if (*sentry == segment[compareBuilder.length()])
-		{
-			// Append another character to the builder
-			compareBuilder += *sentry;
-
-			++sentry;
-		} else if (compareBuilder.length() > 0) {
-			// Sentry must back up all the way to the index directly after the
-			// first index where a potential match was found
-			sentry -= compareBuilder.length() - 1;
-			compareBuilder = "";
-		} else {
-			++sentry;
-		}
-	}
-
-	return compareBuilder == segment;
+	return StringView(*this).indexOf(segment) != StringView::npos;
 }
 
 // -----------------------------------------------------------------------------
@@ -172,67 +519,88 @@ const bool String::contains(const String& segment) const
 
 const String String::toUppercase() const
 {
-	// Create a char array to store the uppercase letters
-	char uppercase[this->length() + 1];
+	STRING_PROFILE("String::toUppercase()");
+
+	const size_t length = this->length();
+
+	// Create a char array on the heap to store the uppercase letters, which
+	// the new String then takes ownership of
+	char* uppercase = new char[length + 1];
+	STRING_COUNT_ALLOC(length + 1);
 
-	// Points to the character in the existing String
-	char* c = this->c_str;
-	while (c < this->c_str + this->length())
+	for (size_t idx = 0; idx < length; idx++)
 	{
 		// Takes the uppercased character and adds it to the array
-		uppercase[c - this->c_str] = std::toupper(*c);
-
-		++c;
+		uppercase[idx] = std::toupper(
+				static_cast<unsigned char>(this->c_str[idx]));
 	}
 
 	// Manually insert null terminating byte at the end
-	uppercase[this->length()] = '\0';
+	uppercase[length] = '\0';
 
-	// Returns a copy of this String
-	return String(uppercase);
+	return String(uppercase, AdoptBuffer());
 }
 
 const String String::toLowercase() const
 {
-	// Create a char array to store the uppercase letters
-	char uppercase[this->length() + 1];
+	STRING_PROFILE("String::toLowercase()");
 
-	// Points to the character in the existing String
-	char* c = this->c_str;
-	while (c < this->c_str + this->length())
-	{
-		// Takes the uppercased character and adds it to the array
-		uppercase[c - this->c_str] = std::tolower(*c);
+	const size_t length = this->length();
+
+	// Create a char array on the heap to store the lowercase letters, which
+	// the new String then takes ownership of
+	char* lowercase = new char[length + 1];
+	STRING_COUNT_ALLOC(length + 1);
 
-		++c;
+	for (size_t idx = 0; idx < length; idx++)
+	{
+		// Takes the lowercased character and adds it to the array
+		lowercase[idx] = std::tolower(
+				static_cast<unsigned char>(this->c_str[idx]));
 	}
 
 	// Manually append null terminating byte
-	uppercase[this->length()] = '\0';
+	lowercase[length] = '\0';
 
-	// Returns a copy of this String
-	return String(uppercase);
+	return String(lowercase, AdoptBuffer());
 }
 
 const String String::remove(unsigned int charIndex) const
 {
-	String removedChar("");
+	STRING_PROFILE("String::remove(unsigned int)");
+
+	const unsigned int length = this->length();
+
+	// Out of bounds indexes are left to substring, which reports them
+	if (charIndex >= length)
+	{
+		return this->substring(0, charIndex) +
+			   this->substring(charIndex + 1, length);
+	}
+
+	StringBuilder removedChar(length - 1);
 
-	removedChar += this->substring(0, charIndex);
-	removedChar += this->substring(charIndex + 1, this->length());
+	removedChar.append(StringView(this->c_str, charIndex));
+	removedChar.append(StringView(this->c_str + charIndex + 1,
+								  length - charIndex - 1));
 
-	return removedChar;
+	return removedChar.toString();
 }
 
 const String String::removeFirst(const String& toRemove) const
 {
-	int indexOf = this->indexOf(toRemove);
+	STRING_PROFILE("String::removeFirst(const String&)");
+
+	const unsigned int indexOf = this->indexOf(toRemove);
+	if (indexOf == String::npos) return *this;
 
 	return this->removeAll(indexOf, indexOf + toRemove.length());
 }
 
 const String String::removeAll(size_t startIndex, size_t endIndex) const
 {
+	STRING_PROFILE("String::removeAll(size_t, size_t)");
+
 	// This represents an illegal case where the starting index is greater than
 	// the ending index. This results in incorrect/unexpected behavior.
 	if (startIndex > endIndex)
@@ -240,16 +608,30 @@ const String String::removeAll(size_t startIndex, size_t endIndex) const
 		throw std::range_error("The startIndex is greater than the endIndex");
 	}
 
+	const size_t length = this->length();
+
+	// Out of bounds indexes are reported by substring
+	if (endIndex > length)
+	{
+		return this->substring(0, startIndex) +
+			   this->substring(endIndex, length);
+	}
+
 	// Simply appends every part of the string which has not been removed
-	String substr = this->substring(0, startIndex) +
-			  this->substring(endIndex, this->length());
+	StringBuilder removed(length - (endIndex - startIndex));
 
-	return substr;
+	removed.append(StringView(this->c_str, startIndex));
+	removed.append(StringView(this->c_str + endIndex, length - endIndex));
+
+	return removed.toString();
 }
 
 const String String::removeAll(const String& toRemove) const
 {
-	String removed("");
+	STRING_PROFILE("String::removeAll(const String&)");
+
+	const unsigned int length = this->length();
+	StringBuilder removed(length);
 
 	// Finds the index locations at every occurrence of toRemove
 	std::vector<int> indexes = this->indexesOf(toRemove);
@@ -258,63 +640,108 @@ const String String::removeAll(const String& toRemove) const
 	int prevIndex = 0; // Marks the starting index of the next substring
 
 	// Builds the string by appending every non removed segment from this
-	// String
+	// String straight out of its characters
 	for (size_t listIdx = 0; listIdx < indexes.size(); listIdx++)
 	{
-		removed += this->substring(prevIndex, indexes.at(listIdx));
+		removed.append(StringView(this->c_str + prevIndex,
+								  indexes.at(listIdx) - prevIndex));
 
 		prevIndex = indexes.at(listIdx) + segmentLength;
 	}
-	removed += this->substring(prevIndex, this->length());
+	removed.append(StringView(this->c_str + prevIndex, length - prevIndex));
 
-	return removed;
+	return removed.toString();
 }
 
 const String String::replaceFirst(const String& toReplace,
 								  const String& replacement) const
 {
-	int indexOf = this->indexOf(toReplace);
-	String replaced(this->removeFirst(toReplace));
+	STRING_PROFILE("String::replaceFirst(const String&, const String&)");
+
+	const unsigned int indexOf = this->indexOf(toReplace);
+	if (indexOf == String::npos) return *this;
+
+	const size_t length = this->length();
+	const size_t segmentLength = toReplace.length();
 
-	return replaced.insert(indexOf, replacement);
+	// Builds the result in one go rather than removing and then inserting
+	StringBuilder replaced(length - segmentLength + replacement.length());
+
+	replaced.append(StringView(this->c_str, indexOf));
+	replaced.append(replacement);
+	replaced.append(StringView(this->c_str + indexOf + segmentLength,
+							   length - indexOf - segmentLength));
+
+	return replaced.toString();
 }
 
 const String String::replaceAll(const String& toReplace,
 								const String& replacement) const
 {
-	// Removes all Strings to be replaced
-	String replaced(this->c_str);
+	STRING_PROFILE("String::replaceAll(const String&, const String&)");
+
+	const size_t length = this->length();
 	std::vector<int> indexes = this->indexesOf(toReplace);
+	if (indexes.empty()) return *this;
+
+	StringBuilder replaced(length + indexes.size() * replacement.length());
 
-	for(unsigned int listIdx = 0; listIdx < indexes.size(); listIdx++)
+	int segmentLength = toReplace.length();
+	int prevIndex = 0; // Marks the starting index of the next substring
+
+	// Builds the string in one pass, copying everything between the matches
+	// with each match replaced. Searching the original String rather than the
+	// partly replaced one keeps a replacement which contains toReplace from
+	// being replaced again.
+	for (size_t listIdx = 0; listIdx < indexes.size(); listIdx++)
 	{
-		replaced = replaced.replaceFirst(toReplace, replacement);
+		replaced.append(StringView(this->c_str + prevIndex,
+								   indexes.at(listIdx) - prevIndex));
+		replaced.append(replacement);
+
+		prevIndex = indexes.at(listIdx) + segmentLength;
 	}
+	replaced.append(StringView(this->c_str + prevIndex, length - prevIndex));
 
-	return replaced;
+	return replaced.toString();
 }
 
 const String String::insert(unsigned int idx, const String& toInsert) const
 {
-	String inserted(this->substring(0, idx));
-	inserted += (toInsert + this->charAt(idx));
-	inserted += this->substring(
-					inserted.length() - toInsert.length(),
-					this->length());
+	STRING_PROFILE("String::insert(unsigned int, const String&)");
+
+	const size_t length = this->length();
+
+	// Error Handling; Inserting at length() appends onto the end
+	if (idx > length)
+	{
+		std::cerr << "The index was out of bounds at: \'" << idx << "\'";
+		return String("");
+	}
+
+	StringBuilder inserted(length + toInsert.length());
+
+	inserted.append(StringView(this->c_str, idx));
+	inserted.append(toInsert);
+	inserted.append(StringView(this->c_str + idx, length - idx));
 
-	return inserted;
+	return inserted.toString();
 }
 
 const String String::substring(size_t startIdx, size_t endIdx) const
 {
+	STRING_PROFILE("String::substring(size_t, size_t)");
+
+	const size_t length = this->length();
+
 	// Error Handling
-	if (startIdx < 0 || startIdx > this->length())
+	if (startIdx < 0 || startIdx > length)
 	{
 		std::cerr << "The starting index was out of bounds at: \'" <<
 								startIdx <<
 								"\'";
 		return String("");
-	} else if (endIdx < 0 || endIdx > this->length()) {
+	} else if (endIdx < 0 || endIdx > length) {
 		std::cerr << "The ending index was out of bounds at: \'" <<
 								endIdx <<
 								"\'";
@@ -324,54 +751,43 @@ const String String::substring(size_t startIdx, size_t endIdx) const
 		return String("");
 	}
 
-	// The String to be returned
-	String substr("");
-
 	// Note: StartIndex is Inclusive and EndIndex is Exclusive
-	const size_t stringLength = (endIdx - startIdx) + 1;
-	char* substrBuilder = new char[stringLength];
-	for (size_t substrIter = startIdx; substrIter < endIdx; substrIter++)
-	{
-		substrBuilder[substrIter - startIdx] = this->c_str[substrIter];
-	}
-	substrBuilder[stringLength - 1] = '\0';
-
-	substr = substrBuilder;
-
-	delete [] substrBuilder;
-	substrBuilder = NULL;
-
-	return substr;
+	return String(this->c_str + startIdx, endIdx - startIdx);
 }
 
-std::vector<String> String::split(const String& regex) const
+std::vector<String> String::split(const StringView& regex) const
 {
+	STRING_PROFILE("String::split(const StringView&)");
+
+	const unsigned int length = this->length();
 	unsigned int regexLen = regex.length();
 
 	std::vector<int> regexes = this->indexesOf(regex);
 	std::vector<String> segments;
 
 	unsigned int prevIndex = 0;
-	// Loops over each regex and substrings all characters between each regex
+	// Loops over each regex and copies all characters between each regex
 	for(unsigned int idx = 0; idx < regexes.size(); idx++)
 	{
 		// Protects against adjacent regexes and regexes located at the
 		// end of the String
 		if (prevIndex != regexes[idx] &&
-			prevIndex != this->length())
+			prevIndex != length)
 		{
-			// Stores the substring segment between two regexes
-			segments.push_back(this->substring(prevIndex, regexes[idx]));
+			// Stores the segment between two regexes
+			segments.push_back(String(this->c_str + prevIndex,
+									  regexes[idx] - prevIndex));
 		}
 
 		prevIndex = regexes[idx] + regexLen;
 	}
 
 	// If the last regex index is not the very last character, then add a
-	// substring from the previous regex to the end of the String
-	if (prevIndex != this->length())
+	// segment from the previous regex to the end of the String
+	if (prevIndex != length)
 	{
-		segments.push_back(this->substring(prevIndex, this->length()));
+		segments.push_back(String(this->c_str + prevIndex,
+								  length - prevIndex));
 	}
 
 	return segments;
@@ -379,6 +795,8 @@ std::vector<String> String::split(const String& regex) const
 
 std::vector<String> String::split(unsigned int idx) const
 {
+	STRING_PROFILE("String::split(unsigned int)");
+
 	std::vector<String> split;
 
 	split.push_back(this->substring(0, idx));
@@ -389,37 +807,774 @@ std::vector<String> String::split(unsigned int idx) const
 
 const String String::trim() const
 {
-	String trimmed(this->c_str);
+	STRING_PROFILE("String::trim()");
+
+	const unsigned char* chars =
+			reinterpret_cast<const unsigned char*>(this->c_str);
+
+	// Finds the first and last characters which are not whitespace, then
+	// copies everything between them at once. An empty or all whitespace
+	// String trims down to an empty String.
+	size_t left = 0;
+	size_t right = this->length();
+	while (left < right && std::isspace(chars[left])) ++left;
+	while (right > left && std::isspace(chars[right - 1])) --right;
+
+	return String(this->c_str + left, right - left);
+}
+
+const std::string String::toStdString() const
+{
+	STRING_PROFILE("String::toStdString()");
+
+	return std::string(this->c_str);
+}
+
+// -----------------------------------------------------------------------------
+// Regular Expressions
+// -----------------------------------------------------------------------------
+
+const bool String::matches(const Regex& regex) const
+{
+	STRING_PROFILE("String::matches(const Regex&)");
+
+	return regex.matches(*this);
+}
+
+const Regex::Match String::find(const Regex& regex, size_t fromIdx) const
+{
+	STRING_PROFILE("String::find(const Regex&, size_t)");
+
+	return regex.find(*this, fromIdx);
+}
+
+std::vector<Regex::Match> String::findAll(const Regex& regex) const
+{
+	STRING_PROFILE("String::findAll(const Regex&)");
+
+	return regex.findAll(*this);
+}
+
+std::vector<String> String::split(const Regex& regex) const
+{
+	STRING_PROFILE("String::split(const Regex&)");
 
-	int charIndex = 0;
-	char charAt = trimmed[charIndex];
+	const StringView text(*this);
+	std::vector<Regex::Match> matches = regex.findAll(text);
+	std::vector<String> segments;
 
-	// Handles left-hand side of the String
-	while (std::isspace(charAt))
+	size_t prevIndex = 0;
+	// Stores every non empty segment between two matches
+	for (size_t idx = 0; idx < matches.size(); idx++)
 	{
-		// Because the first element is always removed, charIndex does not need
-		// to increment. It may remain at 0 and so always remove the first char.
-		trimmed = trimmed.remove(charIndex);
+		if (matches[idx].start() > prevIndex)
+		{
+			segments.push_back(
+					text.subview(prevIndex, matches[idx].start()).toString());
+		}
 
-		charAt = trimmed[charIndex];
+		prevIndex = matches[idx].end();
 	}
-	charIndex = trimmed.length() - 1;
-	charAt = trimmed[charIndex];
 
-	// Handles right-hand side of the String
-	while(std::isspace(charAt))
+	if (prevIndex < text.length())
+	{
+		segments.push_back(text.subview(prevIndex, text.length()).toString());
+	}
+
+	return segments;
+}
+
+const String String::replaceFirst(const Regex& regex,
+								  const String& replacement) const
+{
+	STRING_PROFILE("String::replaceFirst(const Regex&, const String&)");
+
+	const StringView text(*this);
+	Regex::Match match = regex.find(text);
+
+	if (!match.found()) return *this;
+
+	StringBuilder replaced(text.length());
+	replaced.append(text.subview(0, match.start()));
+	appendReplacement(replaced, text, match, replacement);
+	replaced.append(text.subview(match.end(), text.length()));
+
+	return replaced.toString();
+}
+
+const String String::replaceAll(const Regex& regex,
+								const String& replacement) const
+{
+	STRING_PROFILE("String::replaceAll(const Regex&, const String&)");
+
+	const StringView text(*this);
+	std::vector<Regex::Match> matches = regex.findAll(text);
+	StringBuilder replaced(text.length());
+
+	size_t prevIndex = 0;
+	// Copies everything between the matches, with each match replaced
+	for (size_t idx = 0; idx < matches.size(); idx++)
 	{
-		trimmed = trimmed.remove(charIndex--);
+		replaced.append(text.subview(prevIndex, matches[idx].start()));
+		appendReplacement(replaced, text, matches[idx], replacement);
 
-		charAt = trimmed[charIndex];
+		prevIndex = matches[idx].end();
 	}
+	replaced.append(text.subview(prevIndex, text.length()));
 
-	return trimmed;
+	return replaced.toString();
 }
 
-const std::string String::toStdString() const
+// -----------------------------------------------------------------------------
+// Escaping
+// -----------------------------------------------------------------------------
+
+const String String::escapeJson() const
 {
-	return std::string(this->c_str);
+	STRING_PROFILE("String::escapeJson()");
+
+	static const char HEX_DIGITS[] = "0123456789abcdef";
+
+	const size_t length = this->length();
+	size_t idx = findEscape<JsonEscaping>(this->c_str, 0, length);
+	if (idx == length) return *this;
+
+	StringBuilder escaped(escapedCapacity(length));
+	size_t clean = 0; // The index location of the first uncopied character
+
+	// Copies each run of characters which need no escaping in one go
+	while (idx < length)
+	{
+		escaped.append(StringView(this->c_str + clean, idx - clean));
+
+		const unsigned char c = this->c_str[idx];
+		switch (c)
+		{
+			case '"':  escaped.append("\\\""); break;
+			case '\\': escaped.append("\\\\"); break;
+			case '\b': escaped.append("\\b"); break;
+			case '\f': escaped.append("\\f"); break;
+			case '\n': escaped.append("\\n"); break;
+			case '\r': escaped.append("\\r"); break;
+			case '\t': escaped.append("\\t"); break;
+			default:
+				escaped.append("\\u00");
+				escaped.append(HEX_DIGITS[c >> 4]);
+				escaped.append(HEX_DIGITS[c & 0xF]);
+		}
+
+		clean = idx + 1;
+		idx = findEscape<JsonEscaping>(this->c_str, clean, length);
+	}
+	escaped.append(StringView(this->c_str + clean, length - clean));
+
+	return escaped.toString();
+}
+
+const String String::unescapeJson() const
+{
+	STRING_PROFILE("String::unescapeJson()");
+
+	const size_t length = this->length();
+	const char* sentry = static_cast<const char*>(
+			std::memchr(this->c_str, '\\', length));
+	if (sentry == NULL) return *this;
+
+	const char* end = this->c_str + length;
+	const char* clean = this->c_str; // The first uncopied character
+	StringBuilder unescaped(length);
+
+	while (sentry != NULL)
+	{
+		unescaped.append(StringView(clean, sentry - clean));
+
+		if (sentry + 1 == end)
+		{
+			throw std::invalid_argument("The JSON ends with a lone backslash");
+		}
+
+		const char c = sentry[1];
+		sentry += 2;
+		switch (c)
+		{
+			case '"':  unescaped.append('"'); break;
+			case '\\': unescaped.append('\\'); break;
+			case '/':  unescaped.append('/'); break;
+			case 'b':  unescaped.append('\b'); break;
+			case 'f':  unescaped.append('\f'); break;
+			case 'n':  unescaped.append('\n'); break;
+			case 'r':  unescaped.append('\r'); break;
+			case 't':  unescaped.append('\t'); break;
+			case 'u':
+			{
+				unsigned int codePoint;
+				if (end - sentry < 4 || !parseHex(sentry, 4, codePoint))
+				{
+					throw std::invalid_argument(
+							"A JSON \\u escape needs four hexadecimal digits");
+				}
+				sentry += 4;
+
+				// Code points above U+FFFF are written as a pair of UTF-16
+				// surrogates, which must be recombined
+				if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+				{
+					unsigned int low;
+					if (end - sentry < 6 || sentry[0] != '\\' ||
+						sentry[1] != 'u' || !parseHex(sentry + 2, 4, low) ||
+						low < 0xDC00 || low > 0xDFFF)
+					{
+						throw std::invalid_argument(
+								"A JSON high surrogate is not followed by a "
+								"low surrogate");
+					}
+					sentry += 6;
+
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) +
+								(low - 0xDC00);
+				}
+				else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+				{
+					throw std::invalid_argument(
+							"A JSON low surrogate has no high surrogate");
+				}
+				else if (codePoint == 0)
+				{
+					// A null byte would end the String early
+					throw std::invalid_argument(
+							"A JSON \\u0000 escape cannot be unescaped");
+				}
+
+				appendUtf8(unescaped, codePoint);
+				break;
+			}
+			default:
+				throw std::invalid_argument("The JSON has an unknown escape");
+		}
+
+		clean = sentry;
+		sentry = static_cast<const char*>(
+				std::memchr(sentry, '\\', end - sentry));
+	}
+	unescaped.append(StringView(clean, end - clean));
+
+	return unescaped.toString();
+}
+
+const String String::escapeCsv() const
+{
+	STRING_PROFILE("String::escapeCsv()");
+
+	const size_t length = this->length();
+	if (findEscape<CsvEscaping>(this->c_str, 0, length) == length)
+	{
+		return *this;
+	}
+
+	StringBuilder escaped(escapedCapacity(length));
+	escaped.append('"');
+
+	// Only the quotes inside need doubling once the whole field is quoted
+	const char* end = this->c_str + length;
+	const char* clean = this->c_str;
+	const char* quote;
+	while ((quote = static_cast<const char*>(
+			std::memchr(clean, '"', end - clean))) != NULL)
+	{
+		escaped.append(StringView(clean, quote + 1 - clean));
+		escaped.append('"');
+
+		clean = quote + 1;
+	}
+	escaped.append(StringView(clean, end - clean));
+
+	escaped.append('"');
+
+	return escaped.toString();
+}
+
+const String String::unescapeCsv() const
+{
+	STRING_PROFILE("String::unescapeCsv()");
+
+	const size_t length = this->length();
+	if (length == 0 || this->c_str[0] != '"') return *this;
+
+	if (length < 2 || this->c_str[length - 1] != '"')
+	{
+		throw std::invalid_argument("The quoted CSV field is not closed");
+	}
+
+	// Everything between the opening and closing quotes
+	const char* clean = this->c_str + 1;
+	const char* end = this->c_str + length - 1;
+	StringBuilder unescaped(length);
+
+	const char* quote;
+	while ((quote = static_cast<const char*>(
+			std::memchr(clean, '"', end - clean))) != NULL)
+	{
+		if (quote + 1 == end || quote[1] != '"')
+		{
+			throw std::invalid_argument(
+					"The quoted CSV field has a quote which is not doubled");
+		}
+
+		unescaped.append(StringView(clean, quote + 1 - clean));
+		clean = quote + 2;
+	}
+	unescaped.append(StringView(clean, end - clean));
+
+	return unescaped.toString();
+}
+
+const String String::escapeUrl() const
+{
+	STRING_PROFILE("String::escapeUrl()");
+
+	static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+	const size_t length = this->length();
+	size_t idx = findEscape<UrlEscaping>(this->c_str, 0, length);
+	if (idx == length) return *this;
+
+	StringBuilder escaped(escapedCapacity(length));
+	size_t clean = 0; // The index location of the first uncopied character
+
+	while (idx < length)
+	{
+		escaped.append(StringView(this->c_str + clean, idx - clean));
+
+		const unsigned char c = this->c_str[idx];
+		escaped.append('%');
+		escaped.append(HEX_DIGITS[c >> 4]);
+		escaped.append(HEX_DIGITS[c & 0xF]);
+
+		clean = idx + 1;
+		idx = findEscape<UrlEscaping>(this->c_str, clean, length);
+	}
+	escaped.append(StringView(this->c_str + clean, length - clean));
+
+	return escaped.toString();
+}
+
+const String String::unescapeUrl() const
+{
+	STRING_PROFILE("String::unescapeUrl()");
+
+	const size_t length = this->length();
+	const char* sentry = static_cast<const char*>(
+			std::memchr(this->c_str, '%', length));
+	if (sentry == NULL) return *this;
+
+	const char* end = this->c_str + length;
+	const char* clean = this->c_str; // The first uncopied character
+	StringBuilder unescaped(length);
+
+	while (sentry != NULL)
+	{
+		unescaped.append(StringView(clean, sentry - clean));
+
+		unsigned int byte;
+		if (end - sentry < 3 || !parseHex(sentry + 1, 2, byte))
+		{
+			throw std::invalid_argument(
+					"A URL % escape needs two hexadecimal digits");
+		}
+		if (byte == 0)
+		{
+			// A null byte would end the String early
+			throw std::invalid_argument("A URL %00 escape cannot be unescaped");
+		}
+		unescaped.append(static_cast<char>(byte));
+
+		clean = sentry + 3;
+		sentry = static_cast<const char*>(
+				std::memchr(clean, '%', end - clean));
+	}
+	unescaped.append(StringView(clean, end - clean));
+
+	return unescaped.toString();
+}
+
+const String String::escapeHtml() const
+{
+	STRING_PROFILE("String::escapeHtml()");
+
+	const size_t length = this->length();
+	size_t idx = findEscape<HtmlEscaping>(this->c_str, 0, length);
+	if (idx == length) return *this;
+
+	StringBuilder escaped(escapedCapacity(length));
+	size_t clean = 0; // The index location of the first uncopied character
+
+	while (idx < length)
+	{
+		escaped.append(StringView(this->c_str + clean, idx - clean));
+
+		switch (this->c_str[idx])
+		{
+			case '&':  escaped.append("&amp;"); break;
+			case '<':  escaped.append("&lt;"); break;
+			case '>':  escaped.append("&gt;"); break;
+			case '"':  escaped.append("&quot;"); break;
+			default:   escaped.append("&#39;");
+		}
+
+		clean = idx + 1;
+		idx = findEscape<HtmlEscaping>(this->c_str, clean, length);
+	}
+	escaped.append(StringView(this->c_str + clean, length - clean));
+
+	return escaped.toString();
+}
+
+const String String::unescapeHtml() const
+{
+	STRING_PROFILE("String::unescapeHtml()");
+
+	// The longest entity accepted, &#x10FFFF; or &#1114111;, not counting
+	// the '&' and ';'
+	static const size_t MAX_ENTITY_LENGTH = 8;
+
+	const size_t length = this->length();
+	const char* sentry = static_cast<const char*>(
+			std::memchr(this->c_str, '&', length));
+	if (sentry == NULL) return *this;
+
+	const char* end = this->c_str + length;
+	const char* clean = this->c_str; // The first uncopied character
+	StringBuilder unescaped(length);
+
+	while (sentry != NULL)
+	{
+		unescaped.append(StringView(clean, sentry - clean));
+
+		const char* name = sentry + 1;
+		const size_t searchLength = std::min<size_t>(end - name,
+													 MAX_ENTITY_LENGTH + 1);
+		const char* semicolon = static_cast<const char*>(
+				std::memchr(name, ';', searchLength));
+		if (semicolon == NULL)
+		{
+			throw std::invalid_argument("The HTML has an unterminated entity");
+		}
+
+		const StringView entity(name, semicolon - name);
+		if (entity == "amp") {
+			unescaped.append('&');
+		} else if (entity == "lt") {
+			unescaped.append('<');
+		} else if (entity == "gt") {
+			unescaped.append('>');
+		} else if (entity == "quot") {
+			unescaped.append('"');
+		} else if (entity == "apos") {
+			unescaped.append('\'');
+		} else if (entity.length() >= 2 && entity[0] == '#') {
+			// A numeric character reference, in decimal or hexadecimal
+			const bool hex = entity[1] == 'x' || entity[1] == 'X';
+			const size_t first = hex ? 2 : 1;
+			unsigned int codePoint = 0;
+			bool valid = entity.length() > first;
+			for (size_t idx = first; valid && idx < entity.length(); idx++)
+			{
+				const char c = entity[idx];
+				const int digit = hex ? hexValue(c)
+									  : (c >= '0' && c <= '9' ? c - '0' : -1);
+
+				valid = digit >= 0;
+				codePoint = codePoint * (hex ? 16 : 10) + digit;
+			}
+
+			if (!valid || codePoint == 0 || codePoint > 0x10FFFF ||
+				(codePoint >= 0xD800 && codePoint <= 0xDFFF))
+			{
+				throw std::invalid_argument(
+						"The HTML has an invalid character reference");
+			}
+
+			appendUtf8(unescaped, codePoint);
+		} else {
+			throw std::invalid_argument("The HTML has an unknown entity");
+		}
+
+		clean = semicolon + 1;
+		sentry = static_cast<const char*>(
+				std::memchr(clean, '&', end - clean));
+	}
+	unescaped.append(StringView(clean, end - clean));
+
+	return unescaped.toString();
+}
+
+// -----------------------------------------------------------------------------
+// UTF-8
+// -----------------------------------------------------------------------------
+
+String::CodePointIterator::CodePointIterator(const char* position,
+											 const char* end)
+	: sentry(position), end(end)
+{
+}
+
+const unsigned int String::CodePointIterator::operator*() const
+{
+	unsigned int codePoint;
+	if (decodeUtf8(reinterpret_cast<const unsigned char*>(this->sentry),
+				   reinterpret_cast<const unsigned char*>(this->end),
+				   codePoint) == 0)
+	{
+		return REPLACEMENT_CHARACTER;
+	}
+
+	return codePoint;
+}
+
+String::CodePointIterator& String::CodePointIterator::operator++()
+{
+	this->sentry += codePointWidth(
+			reinterpret_cast<const unsigned char*>(this->sentry),
+			reinterpret_cast<const unsigned char*>(this->end));
+
+	return *this;
+}
+
+const char* String::CodePointIterator::position() const
+{
+	return this->sentry;
+}
+
+bool String::CodePointIterator::operator==(
+		const CodePointIterator& toCompare) const
+{
+	return this->sentry == toCompare.sentry;
+}
+
+bool String::CodePointIterator::operator!=(
+		const CodePointIterator& toCompare) const
+{
+	return !(this->operator ==(toCompare));
+}
+
+const bool String::isValidUtf8() const
+{
+	STRING_PROFILE("String::isValidUtf8()");
+
+	std::lock_guard<std::mutex> lock(utf8Lock(this));
+	return this->checkUtf8();
+}
+
+const unsigned int String::codePointCount() const
+{
+	STRING_PROFILE("String::codePointCount()");
+
+	std::lock_guard<std::mutex> lock(utf8Lock(this));
+
+	if (this->checkUtf8())
+	{
+		if (!this->utf8Cache->counted)
+		{
+			// In valid UTF-8, every byte other than a continuation byte
+			// begins a new code point
+			const unsigned char* bytes =
+					reinterpret_cast<const unsigned char*>(this->c_str);
+			const size_t length = this->length();
+
+			unsigned int codePoints = 0;
+			for (size_t idx = 0; idx < length; idx++)
+			{
+				codePoints += (bytes[idx] & 0xC0) != 0x80;
+			}
+
+			this->utf8Cache->codePoints = codePoints;
+			this->utf8Cache->counted = true;
+		}
+	} else if (!this->utf8Cache->counted) {
+		unsigned int codePoints = 0;
+		for (CodePointIterator it = this->codePointBegin();
+			 it != this->codePointEnd(); ++it)
+		{
+			++codePoints;
+		}
+
+		this->utf8Cache->codePoints = codePoints;
+		this->utf8Cache->counted = true;
+	}
+
+	return this->utf8Cache->codePoints;
+}
+
+const bool String::checkUtf8() const
+{
+	if (this->utf8Cache == NULL)
+	{
+		this->utf8Cache = new Utf8Cache();
+		STRING_COUNT_ALLOC(sizeof(Utf8Cache));
+	}
+
+	if (this->utf8Cache->validity == Utf8Cache::UNKNOWN)
+	{
+		const unsigned char* bytes =
+				reinterpret_cast<const unsigned char*>(this->c_str);
+		const size_t length = this->length();
+
+		// Long runs of ASCII are skipped in bulk; only the multibyte
+		// sequences between them are decoded one at a time
+		bool valid = true;
+		size_t idx = 0;
+		while (valid && idx < length)
+		{
+			idx += countAsciiPrefix(bytes + idx, length - idx);
+			if (idx == length) break;
+
+			unsigned int codePoint;
+			size_t width = decodeUtf8(bytes + idx, bytes + length, codePoint);
+
+			valid = width != 0;
+			idx += width;
+		}
+
+		this->utf8Cache->validity = valid ? Utf8Cache::VALID
+										  : Utf8Cache::INVALID;
+	}
+
+	return this->utf8Cache->validity == Utf8Cache::VALID;
+}
+
+const unsigned int String::codePointAt(unsigned int idx) const
+{
+	STRING_PROFILE("String::codePointAt(unsigned int)");
+
+	CodePointIterator it = this->codePointEnd();
+	const char* location = this->codePointLocation(idx);
+
+	if (location == NULL || location == it.position())
+	{
+		throw std::out_of_range("The code point index was out of bounds");
+	}
+
+	return *CodePointIterator(location, it.position());
+}
+
+const String String::substringByCodePoint(size_t startIdx,
+										  size_t endIdx) const
+{
+	STRING_PROFILE("String::substringByCodePoint(size_t, size_t)");
+
+	const char* start = this->codePointLocation(startIdx);
+	const char* end = this->codePointLocation(endIdx);
+
+	// Error Handling
+	if (start == NULL)
+	{
+		std::cerr << "The starting index was out of bounds at: \'" <<
+								startIdx <<
+								"\'";
+		return String("");
+	} else if (end == NULL) {
+		std::cerr << "The ending index was out of bounds at: \'" <<
+								endIdx <<
+								"\'";
+		return String("");
+	} else if (startIdx > endIdx) {
+		std::cerr << "The starting index is larger than the ending index.";
+		return String("");
+	}
+
+	return String(start, end - start);
+}
+
+void String::buildCodePointIndex() const
+{
+	STRING_PROFILE("String::buildCodePointIndex()");
+
+	std::lock_guard<std::mutex> lock(utf8Lock(this));
+
+	if (this->utf8Cache == NULL)
+	{
+		this->utf8Cache = new Utf8Cache();
+		STRING_COUNT_ALLOC(sizeof(Utf8Cache));
+	}
+	if (!this->utf8Cache->checkpoints.empty()) return;
+
+	std::vector<unsigned int>& checkpoints = this->utf8Cache->checkpoints;
+	checkpoints.reserve(this->length() / CODE_POINTS_PER_CHECKPOINT + 1);
+
+	size_t codePoint = 0;
+	for (CodePointIterator it = this->codePointBegin();
+		 it != this->codePointEnd(); ++it, ++codePoint)
+	{
+		if (codePoint % CODE_POINTS_PER_CHECKPOINT == 0)
+		{
+			checkpoints.push_back(it.position() - this->c_str);
+		}
+	}
+
+	// Even an empty String records where its first code point would be
+	if (checkpoints.empty()) checkpoints.push_back(0);
+}
+
+String::CodePointIterator String::codePointBegin() const
+{
+	STRING_PROFILE("String::codePointBegin()");
+
+	return CodePointIterator(this->c_str, this->c_str + this->length());
+}
+
+String::CodePointIterator String::codePointEnd() const
+{
+	STRING_PROFILE("String::codePointEnd()");
+
+	const char* end = this->c_str + this->length();
+
+	return CodePointIterator(end, end);
+}
+
+const char* String::codePointLocation(size_t idx) const
+{
+	const unsigned char* bytes =
+			reinterpret_cast<const unsigned char*>(this->c_str);
+	const unsigned char* end = bytes + this->length();
+
+	// Starts from the closest checkpoint at or before the index, if the
+	// index has been built
+	const unsigned char* sentry = bytes;
+	size_t remaining = idx;
+	{
+		std::lock_guard<std::mutex> lock(utf8Lock(this));
+
+		if (this->utf8Cache != NULL && !this->utf8Cache->checkpoints.empty())
+		{
+			const std::vector<unsigned int>& checkpoints =
+					this->utf8Cache->checkpoints;
+
+			size_t checkpoint = idx / CODE_POINTS_PER_CHECKPOINT;
+			if (checkpoint >= checkpoints.size())
+			{
+				checkpoint = checkpoints.size() - 1;
+			}
+
+			sentry = bytes + checkpoints[checkpoint];
+			remaining = idx - checkpoint * CODE_POINTS_PER_CHECKPOINT;
+		}
+	}
+
+	while (remaining > 0 && sentry < end)
+	{
+		sentry += codePointWidth(sentry, end);
+		--remaining;
+	}
+
+	if (remaining > 0) return NULL;
+
+	return reinterpret_cast<const char*>(sentry);
+}
+
+void String::clearUtf8Cache()
+{
+	delete this->utf8Cache;
+	this->utf8Cache = NULL;
 }
 
 // -----------------------------------------------------------------------------
@@ -428,11 +1583,20 @@ const std::string String::toStdString() const
 
 String& String::operator=(const String& toEqual)
 {
+	STRING_PROFILE("String::operator=(const String&)");
+
 	if (*this != toEqual)
 	{
+		this->clearUtf8Cache();
+
 		delete [] this->c_str;
-		this->c_str = new char[toEqual.length() + 1];
-		std::strcpy(this->c_str, toEqual.c_str);
+		const size_t length = toEqual.length();
+
+		this->c_str = new char[length + 1];
+		STRING_COUNT_ALLOC(length + 1);
+
+		std::memcpy(this->c_str, toEqual.c_str, length + 1);
+		STRING_COUNT_COPY(length);
 	}
 
 	return *this;
@@ -440,40 +1604,44 @@ String& String::operator=(const String& toEqual)
 
 const String String::operator+(const String& toAppend) const
 {
-	// The c_string which will be appended to and returned as a String
-	char* appended = new char[this->length() +
-							  toAppend.length() + 1];
+	STRING_PROFILE("String::operator+(const String&)");
 
-	std::strcpy(appended, this->c_str);
-	std::strcat(appended, toAppend.c_str);
+	const unsigned int length = this->length();
+	const unsigned int appendLength = toAppend.length();
 
-	String stringAppended(appended);
+	// The c_string which will be appended to and handed over to the String
+	char* appended = new char[length + appendLength + 1];
+	STRING_COUNT_ALLOC(length + appendLength + 1);
+	STRING_COUNT_COPY(length + appendLength);
 
-	delete [] appended;
-	appended = NULL;
+	std::memcpy(appended, this->c_str, length);
+	std::memcpy(appended + length, toAppend.c_str, appendLength + 1);
 
-	return stringAppended;
+	return String(appended, AdoptBuffer());
 }
 
 const String String::operator+(char toAppend) const
 {
-	// The c_string which will be appended to and returned as a String
-	char* appended = new char[this->length() + 1 + 1];
+	STRING_PROFILE("String::operator+(char)");
 
-	std::strcpy(appended, this->c_str);
-	appended[this->length()] = toAppend;
-	appended[this->length() + 1] = '\0';
+	const unsigned int length = this->length();
 
-	String stringAppended(appended);
+	// The c_string which will be appended to and handed over to the String
+	char* appended = new char[length + 1 + 1];
+	STRING_COUNT_ALLOC(length + 1 + 1);
+	STRING_COUNT_COPY(length + 1);
 
-	delete [] appended;
-	appended = NULL;
+	std::memcpy(appended, this->c_str, length);
+	appended[length] = toAppend;
+	appended[length + 1] = '\0';
 
-	return stringAppended;
+	return String(appended, AdoptBuffer());
 }
 
 String& String::operator+=(const String& toAppend)
 {
+	STRING_PROFILE("String::operator+=(const String&)");
+
 	return (*this = (*this + toAppend));
 }
 
@@ -483,16 +1651,22 @@ String& String::operator+=(const String& toAppend)
 
 bool String::operator==(const String& toCompare) const
 {
+	STRING_PROFILE("String::operator==(const String&)");
+
 	return std::strcmp(this->c_str, toCompare.c_str) == 0;
 }
 
 bool String::equalsIgnoreCase(const String& toCompare) const
 {
+	STRING_PROFILE("String::equalsIgnoreCase(const String&)");
+
 	return this->toLowercase() == toCompare.toLowercase();
 }
 
 bool String::operator!=(const String& toCompare) const
 {
+	STRING_PROFILE("String::operator!=(const String&)");
+
 	return !(this->operator ==(toCompare));
 }
 
@@ -505,6 +1679,8 @@ std::ostream& operator <<(std::ostream& os, const String& str)
 
 std::istream& operator>>(std::istream& is, String& str)
 {
+	STRING_PROFILE("operator>>(std::istream&, String&)");
+
 	is.clear(); // Removes any previous errors
 
 	// Reads in each character from the stream until some whitespace is found
@@ -8,6 +8,10 @@
 #include <cstring>
 #include <sstream>
 
+#include "Regex.h"
+#include "StringProfiling.h"
+#include "StringView.h"
+
 /**
  * This class stores a series of characters in order and has many methods
  * designed to make manipulation of these characters simple and easy.
@@ -17,6 +21,12 @@ class String
 
 public:
 
+	/**
+	 * Returned by indexOf when the segment was not found. It is -1 converted
+	 * to an unsigned int, so existing comparisons against -1 still hold.
+	 */
+	static const unsigned int npos = static_cast<unsigned int>(-1);
+
 // -----------------------------------------------------------------------------
 // Constructors
 // -----------------------------------------------------------------------------
@@ -27,7 +37,16 @@ public:
 	 *
 	 * @param c_str The characters to be stored
 	 */
-	String(const char* c_str = '\0');
+	String(const char* c_str = "");
+
+	/**
+	 * Creates a new String object from the given number of characters. The
+	 * characters do not need to end with a null terminating byte.
+	 *
+	 * @param chars The characters to be stored
+	 * @param count The number of characters to be stored
+	 */
+	String(const char* chars, size_t count);
 
 	/**
 	 * This creates a new copy of the given String.
@@ -68,10 +87,12 @@ public:
 	 * Returns whether the given String segment can be found in this String.
 	 * This includes correct capitalization.
 	 *
-	 * @param segment The String to be found within this String
+	 * @param segment The String to be found within this String; A string
+	 * 				  literal or FixedString is searched for without being
+	 * 				  copied into a String first
 	 * @return Whether the segment was found
 	 */
-	const bool contains(const String& segment) const;
+	const bool contains(const StringView& segment) const;
 
 	/**
 	 * This first finds the given segment's location within this String and
@@ -79,9 +100,9 @@ public:
 	 *
 	 * @param segment The first String to be found within this String
 	 * @return The index location of the first matching character;
-	 * 		   Will return -1 if no index was found
+	 * 		   Will return npos if no index was found
 	 */
-	const unsigned int indexOf(const String& segment) const;
+	const unsigned int indexOf(const StringView& segment) const;
 
 	/**
 	 * Return a vector containing the index locations of each occurrence of
@@ -90,7 +111,7 @@ public:
 	 * @param segment The String to be found within this String
 	 * @return A vector<int> containing the indexes of the given String
 	 */
-	std::vector<int> indexesOf(const String& segment) const;
+	std::vector<int> indexesOf(const StringView& segment) const;
 
 // -----------------------------------------------------------------------------
 // String Manipulation
@@ -111,7 +132,9 @@ public:
 	 *
 	 * @param charIndex The index of the character to be removed
 	 * @return The new resulting String;
-	 * 		   Will return an empty String if the given index is out of bounds
+	 * 		   Will return an empty String if the given index is past the
+	 * 		   end, or an unchanged copy if it is the length, reporting the
+	 * 		   error either way just as substring does
 	 */
 	const String remove(unsigned int charIndex) const;
 
@@ -119,7 +142,8 @@ public:
 	 * Removes the first occurrence of the given String in this String.
 	 *
 	 * @param toRemove The String to be removed from this String
-	 * @return A new String whose characters have been removed
+	 * @return A new String whose characters have been removed;
+	 * 		   Will return an unchanged copy if toRemove was not found
 	 */
 	const String removeFirst(const String& toRemove) const;
 
@@ -156,7 +180,8 @@ public:
 	 *
 	 * @param toReplace The String to be replaced
 	 * @param replacement The replacement
-	 * @return A new String
+	 * @return A new String;
+	 * 		   Will return an unchanged copy if toReplace was not found
 	 */
 	const String replaceFirst(const String& toReplace,
 							  const String& replacement) const;
@@ -174,6 +199,7 @@ public:
 
 	/**
 	 * Inserts the given String into this String at the given index location.
+	 * Inserting at length() appends it onto the end.
 	 *
 	 * @param idx The index location to be inserted at
 	 * @param toInsert The String being inserted
@@ -200,6 +226,9 @@ public:
 	 * If a regex is located at either the beginning or end of the String such
 	 * as with the colons in ":IgnoresTheseColons:", it will be omitted.
 	 *
+	 * Note: Despite its name, the regex is matched literally, character for
+	 * character. To split on a pattern, see split(const Regex&).
+	 *
 	 * @example
 	 * String s("This:Will:Split");
 	 * s.split(":"); // Returns a vector with [This],[Will],[Split]
@@ -211,7 +240,7 @@ public:
 	 * @param regex The String identifier which marks each location to be split
 	 * @return A vector list containing each segment
 	 */
-	std::vector<String> split(const String& regex) const;
+	std::vector<String> split(const StringView& regex) const;
 
 	/**
 	 * Splits the String into two segments occurring at the given index
@@ -253,6 +282,368 @@ public:
 	 */
 	const std::string toStdString() const;
 
+// -----------------------------------------------------------------------------
+// Joining
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Joins each String between first and last into one String, placing the
+	 * separator between every pair of adjacent Strings. The total length is
+	 * measured first so that the result is allocated exactly once.
+	 *
+	 * @example
+	 * std::vector<String> v = String("This:Will:Join").split(":");
+	 * String::join(v.begin(), v.end(), ", "); // Returns [This, Will, Join]
+	 *
+	 * @param first An iterator to the first String to be joined
+	 * @param last An iterator to the position after the last String
+	 * @param separator The String placed between each pair of Strings
+	 * @return The joined String
+	 */
+	template <class Iterator>
+	static const String join(Iterator first, Iterator last,
+							 const String& separator)
+	{
+		STRING_PROFILE("String::join(Iterator, Iterator, const String&)");
+
+		const size_t separatorLength = std::strlen(separator.c_str);
+
+		// Measures every piece before copying any of them
+		size_t totalLength = 0;
+		for (Iterator piece = first; piece != last; ++piece)
+		{
+			const char* chars = static_cast<const String&>(*piece).c_str;
+			if (piece != first) totalLength += separatorLength;
+			totalLength += std::strlen(chars);
+		}
+
+		char* joined = new char[totalLength + 1];
+		STRING_COUNT_ALLOC(totalLength + 1);
+		STRING_COUNT_COPY(totalLength);
+		char* end = joined;
+		for (Iterator piece = first; piece != last; ++piece)
+		{
+			if (piece != first)
+			{
+				std::memcpy(end, separator.c_str, separatorLength);
+				end += separatorLength;
+			}
+
+			const char* chars = static_cast<const String&>(*piece).c_str;
+			const size_t pieceLength = std::strlen(chars);
+			std::memcpy(end, chars, pieceLength);
+			end += pieceLength;
+		}
+		*end = '\0';
+
+		return String(joined, AdoptBuffer());
+	}
+
+	/**
+	 * Joins every String in the given range, such as a std::vector<String>,
+	 * placing the separator between every pair of adjacent Strings.
+	 *
+	 * @param values The Strings to be joined
+	 * @param separator The String placed between each pair of Strings
+	 * @return The joined String
+	 */
+	template <class Range>
+	static const String join(const Range& values, const String& separator)
+	{
+		return join(values.begin(), values.end(), separator);
+	}
+
+// -----------------------------------------------------------------------------
+// Regular Expressions
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @param regex The Regex to be matched
+	 * @return Whether the whole of this String matches the Regex
+	 */
+	const bool matches(const Regex& regex) const;
+
+	/**
+	 * Finds the first part of this String which matches the Regex.
+	 *
+	 * @example
+	 * String s("key=value");
+	 * Regex::Match m = s.find(Regex("(\\w+)=(\\w+)"));
+	 * s.substring(m.start(2), m.end(2)); // Returns [value]
+	 *
+	 * @param regex The Regex to be found
+	 * @param fromIdx The index location where the search begins
+	 * @return The match; Regex::Match::found returns false if nothing matched
+	 */
+	const Regex::Match find(const Regex& regex, size_t fromIdx = 0) const;
+
+	/**
+	 * Finds every part of this String which matches the Regex, from left to
+	 * right. Matches never overlap.
+	 *
+	 * @param regex The Regex to be found
+	 * @return Each match in order
+	 */
+	std::vector<Regex::Match> findAll(const Regex& regex) const;
+
+	/**
+	 * Splits the String at every match of the Regex, following the same rules
+	 * as split(const StringView&): the matches themselves are omitted, and so
+	 * are any empty segments between adjacent matches or at either end.
+	 *
+	 * @example
+	 * String s("one, two;three");
+	 * s.split(Regex("[,;] *")); // Returns a vector with [one],[two],[three]
+	 *
+	 * @param regex The Regex which marks each location to be split
+	 * @return A vector list containing each segment
+	 */
+	std::vector<String> split(const Regex& regex) const;
+
+	/**
+	 * Replaces the first match of the Regex with the given replacement. Within
+	 * the replacement, $0 to $9 stand for the text of that capture group and
+	 * $$ stands for a single '$'. A group which did not take part in the match
+	 * is replaced with nothing.
+	 *
+	 * @param regex The Regex to be replaced
+	 * @param replacement The replacement
+	 * @return A new String
+	 */
+	const String replaceFirst(const Regex& regex,
+							  const String& replacement) const;
+
+	/**
+	 * Replaces every match of the Regex with the given replacement, which may
+	 * refer to capture groups in the same way as replaceFirst.
+	 *
+	 * @example
+	 * String s("2015-04-01");
+	 * s.replaceAll(Regex("(\\d+)-(\\d+)-(\\d+)"), "$3/$2/$1"); // [01/04/2015]
+	 *
+	 * @param regex The Regex to be replaced
+	 * @param replacement The replacement
+	 * @return A new String
+	 */
+	const String replaceAll(const Regex& regex,
+							const String& replacement) const;
+
+// -----------------------------------------------------------------------------
+// Escaping
+// -----------------------------------------------------------------------------
+//
+// Each escape method makes a single pass over the String, finding the
+// characters which need escaping sixteen at a time where SSE2 is available
+// and copying the runs of characters between them in bulk. A String with
+// nothing to escape is simply copied. The unescape methods throw
+// std::invalid_argument for input which could not have come from the
+// matching escape method or from another well formed source.
+
+	/**
+	 * Escapes the String for use inside a JSON string literal. Quotes,
+	 * backslashes and control characters are escaped; the surrounding quotes
+	 * are not added.
+	 *
+	 * @example
+	 * String s("say \"hi\"\n");
+	 * s.escapeJson(); // Returns [say \"hi\"\n]
+	 *
+	 * @return A new String
+	 */
+	const String escapeJson() const;
+
+	/**
+	 * Reverses escapeJson, including \uXXXX escapes (and surrogate pairs),
+	 * which are written as UTF-8.
+	 *
+	 * @return A new String
+	 * @throws std::invalid_argument If an escape is unknown or incomplete, or
+	 * 		   is \u0000, as a String cannot hold a null byte
+	 */
+	const String unescapeJson() const;
+
+	/**
+	 * Escapes the String as a single CSV field following RFC 4180. A field
+	 * containing a comma, quote or line break is wrapped in quotes with each
+	 * quote inside doubled; any other field is returned unchanged.
+	 *
+	 * @example
+	 * String s("5\" disk, used");
+	 * s.escapeCsv(); // Returns ["5"" disk, used"]
+	 *
+	 * @return A new String
+	 */
+	const String escapeCsv() const;
+
+	/**
+	 * Reverses escapeCsv. A field which does not begin with a quote is
+	 * returned unchanged.
+	 *
+	 * @return A new String
+	 * @throws std::invalid_argument If a quoted field is not closed or has a
+	 * 		   quote inside which is not doubled
+	 */
+	const String unescapeCsv() const;
+
+	/**
+	 * Percent-encodes every byte other than the unreserved characters of
+	 * RFC 3986 (letters, digits, '-', '.', '_' and '~').
+	 *
+	 * @example
+	 * String s("a b&c");
+	 * s.escapeUrl(); // Returns [a%20b%26c]
+	 *
+	 * @return A new String
+	 */
+	const String escapeUrl() const;
+
+	/**
+	 * Decodes every %XX escape. A '+' is left as it is rather than being
+	 * treated as a space.
+	 *
+	 * @return A new String
+	 * @throws std::invalid_argument If a '%' is not followed by two
+	 * 		   hexadecimal digits, or the escape is %00, as a String cannot
+	 * 		   hold a null byte
+	 */
+	const String unescapeUrl() const;
+
+	/**
+	 * Escapes the characters &, <, >, " and ' as HTML entities, which makes
+	 * the String safe to use as element text or as a quoted attribute value.
+	 *
+	 * @example
+	 * String s("<b>Tom & Jerry</b>");
+	 * s.escapeHtml(); // Returns [&lt;b&gt;Tom &amp; Jerry&lt;/b&gt;]
+	 *
+	 * @return A new String
+	 */
+	const String escapeHtml() const;
+
+	/**
+	 * Reverses escapeHtml. Also accepts &apos; along with decimal and
+	 * hexadecimal character references such as &#233; and &#xE9;, which are
+	 * written as UTF-8.
+	 *
+	 * @return A new String
+	 * @throws std::invalid_argument If a '&' does not begin one of the
+	 * 		   entities above
+	 */
+	const String unescapeHtml() const;
+
+// -----------------------------------------------------------------------------
+// UTF-8
+// -----------------------------------------------------------------------------
+//
+// The methods above treat every byte as its own character. The methods below
+// instead treat the String as UTF-8, where a single code point may take up to
+// four bytes. Their results are cached on the String the first time they are
+// needed. As with every other const method, several threads may call them on
+// the same String at once; the cache is guarded by a lock, which is shared
+// with a few other Strings rather than making every String larger. A String
+// which is being changed must not be used by any other thread.
+
+	/**
+	 * Steps through the code points of a UTF-8 String. A byte which does not
+	 * begin a valid UTF-8 sequence is returned as U+FFFD on its own.
+	 *
+	 * @example
+	 * String s("h\xC3\xA9");
+	 * for (String::CodePointIterator it = s.codePointBegin();
+	 * 		it != s.codePointEnd(); ++it)
+	 * {
+	 * 		*it; // Returns 0x68, then 0xE9
+	 * }
+	 */
+	class CodePointIterator
+	{
+
+	public:
+
+		CodePointIterator(const char* position, const char* end);
+
+		/**
+		 * @return The code point at the iterator's position
+		 */
+		const unsigned int operator*() const;
+
+		/**
+		 * Moves on to the next code point.
+		 *
+		 * @return This iterator
+		 */
+		CodePointIterator& operator++();
+
+		/**
+		 * @return A pointer to the first byte of the current code point
+		 */
+		const char* position() const;
+
+		bool operator==(const CodePointIterator& toCompare) const;
+		bool operator!=(const CodePointIterator& toCompare) const;
+
+	private:
+		const char* sentry; // The first byte of the current code point
+		const char* end;    // The null terminating bit of the String
+
+	};
+
+	/**
+	 * Returns whether the String holds well formed UTF-8. Overlong encodings,
+	 * surrogates, and code points above U+10FFFF are all rejected.
+	 *
+	 * The String is only validated the first time this is called.
+	 *
+	 * @return Whether the String is valid UTF-8
+	 */
+	const bool isValidUtf8() const;
+
+	/**
+	 * Returns the number of code points in the String. Any byte which does not
+	 * begin a valid UTF-8 sequence counts as a code point of its own.
+	 *
+	 * @return The total number of code points in the String
+	 */
+	const unsigned int codePointCount() const;
+
+	/**
+	 * Returns the code point at the given code point index. This takes time
+	 * proportional to the index unless buildCodePointIndex has been called.
+	 *
+	 * @param idx An integer between 0 and the code point count of the String
+	 * @return The code point at the given index location
+	 */
+	const unsigned int codePointAt(unsigned int idx) const;
+
+	/**
+	 * Returns a segment from this String, counted in code points rather than
+	 * bytes. The segment never splits a multibyte sequence.
+	 *
+	 * @param startIdx The first code point of this String to be included
+	 * @param endIdx The code point AFTER the last code point of this String to
+	 * 		  be included (exclusive)
+	 * @return The substring
+	 */
+	const String substringByCodePoint(size_t startIdx, size_t endIdx) const;
+
+	/**
+	 * Records the byte location of every 16th code point so that codePointAt
+	 * and substringByCodePoint can find any code point in constant time. The
+	 * index uses roughly a quarter of a byte per code point and is kept until
+	 * the String is changed.
+	 */
+	void buildCodePointIndex() const;
+
+	/**
+	 * @return An iterator to the first code point of the String
+	 */
+	CodePointIterator codePointBegin() const;
+
+	/**
+	 * @return An iterator to the position after the last code point
+	 */
+	CodePointIterator codePointEnd() const;
+
 // -----------------------------------------------------------------------------
 // Operators
 // -----------------------------------------------------------------------------
@@ -269,14 +660,19 @@ public:
 	template <class T>
 	String& operator=(const T& toEqual)
 	{
+		STRING_PROFILE("String::operator=(T)");
+
 		delete [] this->c_str;
 		this->c_str = NULL;
+		this->clearUtf8Cache();
 
 		// Use a string stream to transfer the information to the c_str
 		std::stringstream equalStream;
 
 		equalStream << toEqual;
 		this->c_str = new char[equalStream.str().size() + 1];
+		STRING_COUNT_ALLOC(equalStream.str().size() + 1);
+		STRING_COUNT_COPY(equalStream.str().size());
 
 		// Copies the characters from the stream into the internal cstring
 		std::strcpy(this->c_str, equalStream.str().c_str());
@@ -297,9 +693,13 @@ public:
 	template <class T>
 	const String operator+(T toAppend) const
 	{
+		STRING_PROFILE("String::operator+(T)");
+
 		std::stringstream appendStream;
 
 		appendStream << this->c_str << toAppend;
+		STRING_COUNT_ALLOC(appendStream.str().size() + 1);
+		STRING_COUNT_COPY(appendStream.str().size());
 
 		return String(appendStream.str().c_str());
 	}
@@ -315,6 +715,8 @@ public:
 	template <class T>
 	String& operator+=(const T toAppend)
 	{
+		STRING_PROFILE("String::operator+=(T)");
+
 		return (*this = (*this + toAppend));
 	}
 
@@ -372,7 +774,47 @@ public:
 	friend std::istream& operator>>(std::istream& is, String& str);
 
 private:
+	friend class StringView;
+	friend class StringBuilder;
+	friend class CompressedString;
+
+	/**
+	 * Marks the constructor which takes ownership of an existing buffer.
+	 */
+	struct AdoptBuffer {};
+
+	/**
+	 * Creates a String which takes ownership of the given null terminated
+	 * buffer rather than copying it. The buffer must have been allocated
+	 * with new[].
+	 *
+	 * @param buffer The buffer to be owned
+	 */
+	String(char* buffer, AdoptBuffer);
+
+	/**
+	 * Finds the first byte of the code point at the given code point index.
+	 * Returns NULL if the String has fewer code points than the index.
+	 */
+	const char* codePointLocation(size_t idx) const;
+
+	/**
+	 * Does the work of isValidUtf8. The caller must hold the String's UTF-8
+	 * lock.
+	 */
+	const bool checkUtf8() const;
+
+	/**
+	 * Forgets everything cached about the String's UTF-8 contents. This must
+	 * be called whenever the characters change.
+	 */
+	void clearUtf8Cache();
+
+	struct Utf8Cache;
+
 	char* c_str; // Dynamically stores every character in the String
+	mutable Utf8Cache* utf8Cache; // Lazily created by the UTF-8 methods, and
+								  // only used while holding the UTF-8 lock
 
 };
 
@@ -0,0 +1,224 @@
+
+#include "StringBuilder.h"
+#include "StringProfiling.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+/**
+ * Writes the digits of the given number into the end of the given buffer and
+ * returns a pointer to the first digit.
+ */
+static char* formatUnsigned(unsigned long long number, char* end)
+{
+	char* digit = end;
+	do
+	{
+		*--digit = static_cast<char>('0' + number % 10);
+		number /= 10;
+	} while (number != 0);
+
+	return digit;
+}
+
+StringBuilder::StringBuilder(size_t capacity /* Default of 0 */)
+	: buffer(NULL), count(0), capacity(0)
+{
+	this->reserve(capacity);
+}
+
+StringBuilder::StringBuilder(const StringBuilder& toCopy)
+	: buffer(NULL), count(0), capacity(0)
+{
+	this->appendChars(toCopy.buffer, toCopy.count);
+}
+
+StringBuilder::~StringBuilder()
+{
+	delete [] this->buffer;
+	this->buffer = NULL;
+}
+
+StringBuilder& StringBuilder::operator=(const StringBuilder& toEqual)
+{
+	if (this != &toEqual)
+	{
+		this->clear();
+		this->appendChars(toEqual.buffer, toEqual.count);
+	}
+
+	return *this;
+}
+
+// -----------------------------------------------------------------------------
+// Builder Information
+// -----------------------------------------------------------------------------
+
+const size_t StringBuilder::length() const
+{
+	return this->count;
+}
+
+const StringView StringBuilder::view() const
+{
+	if (this->buffer == NULL) return StringView();
+
+	return StringView(this->buffer, this->count);
+}
+
+// -----------------------------------------------------------------------------
+// Appending
+// -----------------------------------------------------------------------------
+
+StringBuilder& StringBuilder::append(const String& toAppend)
+{
+	return this->append(StringView(toAppend));
+}
+
+StringBuilder& StringBuilder::append(const StringView& toAppend)
+{
+	return this->appendChars(toAppend.data(), toAppend.length());
+}
+
+StringBuilder& StringBuilder::append(const char* toAppend)
+{
+	return this->appendChars(toAppend, std::strlen(toAppend));
+}
+
+StringBuilder& StringBuilder::append(char toAppend)
+{
+	return this->appendChars(&toAppend, 1);
+}
+
+StringBuilder& StringBuilder::append(int toAppend)
+{
+	return this->append(static_cast<long long>(toAppend));
+}
+
+StringBuilder& StringBuilder::append(long toAppend)
+{
+	return this->append(static_cast<long long>(toAppend));
+}
+
+StringBuilder& StringBuilder::append(long long toAppend)
+{
+	char digits[24];
+	char* end = digits + sizeof(digits);
+
+	// Negating as unsigned keeps the smallest long long from overflowing
+	unsigned long long magnitude = static_cast<unsigned long long>(toAppend);
+	if (toAppend < 0) magnitude = 0 - magnitude;
+
+	char* first = formatUnsigned(magnitude, end);
+	if (toAppend < 0) *--first = '-';
+
+	return this->appendChars(first, end - first);
+}
+
+StringBuilder& StringBuilder::append(unsigned int toAppend)
+{
+	return this->append(static_cast<unsigned long long>(toAppend));
+}
+
+StringBuilder& StringBuilder::append(unsigned long toAppend)
+{
+	return this->append(static_cast<unsigned long long>(toAppend));
+}
+
+StringBuilder& StringBuilder::append(unsigned long long toAppend)
+{
+	char digits[24];
+	char* end = digits + sizeof(digits);
+	char* first = formatUnsigned(toAppend, end);
+
+	return this->appendChars(first, end - first);
+}
+
+StringBuilder& StringBuilder::append(double toAppend)
+{
+	// Matches the default formatting of a std::stringstream, which is what
+	// String::operator+ uses
+	char digits[32];
+	int written = std::snprintf(digits, sizeof(digits), "%g", toAppend);
+
+	return this->appendChars(digits, written);
+}
+
+void StringBuilder::reserve(size_t capacity)
+{
+	if (capacity <= this->capacity) return;
+
+	// Leaves room for the null terminating bit added by toString
+	char* grown = new char[capacity + 1];
+	STRING_COUNT_ALLOC(capacity + 1);
+
+	if (this->count > 0)
+	{
+		std::memcpy(grown, this->buffer, this->count);
+		STRING_COUNT_COPY(this->count);
+	}
+
+	delete [] this->buffer;
+	this->buffer = grown;
+	this->capacity = capacity;
+}
+
+void StringBuilder::clear()
+{
+	this->count = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Finishing
+// -----------------------------------------------------------------------------
+
+const String StringBuilder::toString()
+{
+	if (this->buffer == NULL) return String("");
+
+	this->buffer[this->count] = '\0';
+	char* finished = this->buffer;
+
+	this->buffer = NULL;
+	this->count = 0;
+	this->capacity = 0;
+
+	return String(finished, String::AdoptBuffer());
+}
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+StringBuilder& StringBuilder::appendChars(const char* chars, size_t count)
+{
+	if (this->count + count > this->capacity)
+	{
+		size_t grown = this->capacity * 2;
+		if (grown < this->count + count) grown = this->count + count;
+		if (grown < 16) grown = 16;
+
+		// The characters may be a view of this builder's own buffer, which
+		// reserve frees once it has copied them into the grown one. They are
+		// then found again at the same offset in the grown buffer.
+		std::less_equal<const char*> notAfter;
+		const bool own = this->buffer != NULL &&
+				notAfter(this->buffer, chars) &&
+				notAfter(chars + count, this->buffer + this->count);
+		const size_t offset = own ? chars - this->buffer : 0;
+
+		this->reserve(grown);
+
+		if (own) chars = this->buffer + offset;
+	}
+
+	if (count > 0)
+	{
+		std::memcpy(this->buffer + this->count, chars, count);
+		STRING_COUNT_COPY(count);
+		this->count += count;
+	}
+
+	return *this;
+}
@@ -0,0 +1,140 @@
+
+#ifndef STRINGBUILDER_H_
+#define STRINGBUILDER_H_
+
+#include "String.h"
+#include "StringView.h"
+
+#include <cstddef>
+
+/**
+ * This class assembles a String out of many smaller pieces. Each piece is
+ * copied into one growable buffer which doubles in size whenever it runs out
+ * of room, so appending n pieces only re-allocates O(log n) times.
+ *
+ * @example
+ * StringBuilder builder;
+ * builder.append("Line ").append(12).append(':').append(3.5);
+ * String s = builder.toString(); // Returns [Line 12:3.5]
+ */
+class StringBuilder
+{
+
+public:
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates a new empty StringBuilder.
+	 *
+	 * @param capacity The number of characters to make room for up front
+	 */
+	StringBuilder(size_t capacity = 0);
+
+	/**
+	 * This creates a new copy of the given StringBuilder.
+	 *
+	 * @param toCopy The StringBuilder to be copied
+	 */
+	StringBuilder(const StringBuilder& toCopy);
+
+	/**
+	 * Destructs the StringBuilder.
+	 */
+	~StringBuilder();
+
+	StringBuilder& operator=(const StringBuilder& toEqual);
+
+// -----------------------------------------------------------------------------
+// Builder Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The total number of characters appended so far.
+	 */
+	const size_t length() const;
+
+	/**
+	 * @return A view of the characters appended so far. The view is only valid
+	 * 		   until the next change to this StringBuilder.
+	 */
+	const StringView view() const;
+
+// -----------------------------------------------------------------------------
+// Appending
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Appends the given piece onto the end. Numbers are written the same way
+	 * as String::operator+ writes them.
+	 *
+	 * @param toAppend The piece to be appended
+	 * @return This StringBuilder
+	 */
+	StringBuilder& append(const String& toAppend);
+	StringBuilder& append(const StringView& toAppend);
+	StringBuilder& append(const char* toAppend);
+	StringBuilder& append(char toAppend);
+	StringBuilder& append(int toAppend);
+	StringBuilder& append(long toAppend);
+	StringBuilder& append(long long toAppend);
+	StringBuilder& append(unsigned int toAppend);
+	StringBuilder& append(unsigned long toAppend);
+	StringBuilder& append(unsigned long long toAppend);
+	StringBuilder& append(double toAppend);
+
+	/**
+	 * Appends the given piece onto the end.
+	 *
+	 * @param toAppend The piece to be appended
+	 * @return This StringBuilder
+	 */
+	template <class T>
+	StringBuilder& operator+=(const T& toAppend)
+	{
+		return this->append(toAppend);
+	}
+
+	/**
+	 * Makes sure there is room for at least the given number of characters
+	 * without another re-allocation.
+	 *
+	 * @param capacity The total number of characters to make room for
+	 */
+	void reserve(size_t capacity);
+
+	/**
+	 * Removes every character appended so far but keeps the buffer for reuse.
+	 */
+	void clear();
+
+// -----------------------------------------------------------------------------
+// Finishing
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Hands the buffer over to a new String without copying its characters.
+	 * The StringBuilder is left empty afterwards.
+	 *
+	 * @return The assembled String
+	 */
+	const String toString();
+
+private:
+
+	/**
+	 * Appends the given number of characters onto the end.
+	 */
+	StringBuilder& appendChars(const char* chars, size_t count);
+
+	char* buffer;    // Dynamically stores every character appended so far
+	size_t count;    // The number of characters appended so far
+	size_t capacity; // The number of characters the buffer has room for
+
+};
+
+
+
+#endif
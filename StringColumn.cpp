@@ -0,0 +1,340 @@
+
+#include "StringColumn.h"
+
+#include <cctype>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Columns with fewer values than this per thread are not worth splitting
+static const size_t MIN_VALUES_PER_THREAD = 4096;
+
+/**
+ * Splits the values [0, count) into one contiguous range per thread. Range i
+ * spans bounds[i] to bounds[i + 1]. Every boundary is a multiple of align so
+ * that no two threads write to the same byte of a bitmap. There is always at
+ * least one range, which is empty when count is 0.
+ */
+static std::vector<size_t> partition(size_t count, unsigned int threads,
+									 size_t align)
+{
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	size_t parts = count / MIN_VALUES_PER_THREAD;
+	if (parts > threads) parts = threads;
+	if (parts == 0) parts = 1;
+
+	std::vector<size_t> bounds(1, 0);
+	size_t perPart = ((count / parts) / align + 1) * align;
+	for (size_t start = perPart; start < count; start += perPart)
+	{
+		bounds.push_back(start);
+	}
+	bounds.push_back(count);
+
+	return bounds;
+}
+
+/**
+ * Runs kernel(part, start, end) once for every range of the given bounds.
+ * The first range is run on the calling thread.
+ */
+template <class Kernel>
+static void runParts(const std::vector<size_t>& bounds, Kernel kernel)
+{
+	std::vector<std::thread> workers;
+	for (size_t part = 1; part + 1 < bounds.size(); part++)
+	{
+		workers.push_back(std::thread(kernel, part,
+									  bounds[part], bounds[part + 1]));
+	}
+
+	kernel(0, bounds[0], bounds[1]);
+
+	for (size_t worker = 0; worker < workers.size(); worker++)
+	{
+		workers[worker].join();
+	}
+}
+
+StringColumn::StringColumn()
+	: offsets(1, 0)
+{
+}
+
+StringColumn::StringColumn(const std::vector<String>& values)
+	: offsets(1, 0)
+{
+	this->offsets.reserve(values.size() + 1);
+	for (size_t idx = 0; idx < values.size(); idx++)
+	{
+		this->append(values[idx]);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Column Information
+// -----------------------------------------------------------------------------
+
+const size_t StringColumn::size() const
+{
+	return this->offsets.size() - 1;
+}
+
+const size_t StringColumn::byteLength() const
+{
+	return this->arena.size();
+}
+
+const StringView StringColumn::operator[](size_t idx) const
+{
+	const size_t start = this->offsets[idx];
+
+	// An empty arena has no first element to point at
+	if (this->arena.empty()) return StringView();
+
+	return StringView(&this->arena[0] + start, this->offsets[idx + 1] - start);
+}
+
+const String StringColumn::at(size_t idx) const
+{
+	return (*this)[idx].toString();
+}
+
+std::vector<String> StringColumn::toVector() const
+{
+	std::vector<String> values;
+	values.reserve(this->size());
+
+	for (size_t idx = 0; idx < this->size(); idx++)
+	{
+		values.push_back(this->at(idx));
+	}
+
+	return values;
+}
+
+void StringColumn::append(const StringView& value)
+{
+	this->arena.insert(this->arena.end(),
+					   value.data(), value.data() + value.length());
+	this->offsets.push_back(this->arena.size());
+}
+
+void StringColumn::reserve(size_t values, size_t bytes)
+{
+	this->offsets.reserve(values + 1);
+	this->arena.reserve(bytes);
+}
+
+// -----------------------------------------------------------------------------
+// Batch Operations
+// -----------------------------------------------------------------------------
+
+const StringColumn StringColumn::trim(unsigned int threads) const
+{
+	std::vector<size_t> bounds = partition(this->size(), threads, 1);
+	std::vector<StringColumn> parts(bounds.size() - 1);
+
+	runParts(bounds, [this, &parts](size_t part, size_t start, size_t end)
+	{
+		StringColumn& trimmed = parts[part];
+		trimmed.reserve(end - start,
+						this->offsets[end] - this->offsets[start]);
+
+		for (size_t idx = start; idx < end; idx++)
+		{
+			StringView value = (*this)[idx];
+			size_t left = 0;
+			size_t right = value.length();
+
+			// Whitespace is skipped rather than removed one character at a
+			// time, so trimming never allocates per value
+			while (left < right &&
+				   std::isspace(static_cast<unsigned char>(value[left])))
+			{
+				++left;
+			}
+			while (right > left &&
+				   std::isspace(static_cast<unsigned char>(value[right - 1])))
+			{
+				--right;
+			}
+
+			trimmed.append(value.subview(left, right));
+		}
+	});
+
+	StringColumn trimmed;
+	trimmed.reserve(this->size(), this->byteLength());
+	for (size_t part = 0; part < parts.size(); part++)
+	{
+		trimmed.appendColumn(parts[part]);
+	}
+
+	return trimmed;
+}
+
+const StringColumn StringColumn::toUppercase(unsigned int threads) const
+{
+	return this->convertCase(&::toupper, threads);
+}
+
+const StringColumn StringColumn::toLowercase(unsigned int threads) const
+{
+	return this->convertCase(&::tolower, threads);
+}
+
+std::vector<unsigned char> StringColumn::contains(const StringView& needle,
+												  unsigned int threads) const
+{
+	std::vector<unsigned char> bitmap((this->size() + 7) / 8, 0);
+
+	// Ranges are aligned to whole bytes of the bitmap
+	std::vector<size_t> bounds = partition(this->size(), threads, 8);
+
+	runParts(bounds, [this, &bitmap, &needle](size_t, size_t start, size_t end)
+	{
+		for (size_t idx = start; idx < end; idx++)
+		{
+			if ((*this)[idx].indexOf(needle) != StringView::npos)
+			{
+				bitmap[idx / 8] |= static_cast<unsigned char>(1 << (idx % 8));
+			}
+		}
+	});
+
+	return bitmap;
+}
+
+const StringColumn StringColumn::replaceAll(const String& toReplace,
+											const String& replacement,
+											unsigned int threads) const
+{
+	const StringView needle(toReplace);
+	const StringView substitute(replacement);
+
+	// Like String::replaceAll, an empty String never matches
+	if (needle.length() == 0) return *this;
+
+	std::vector<size_t> bounds = partition(this->size(), threads, 1);
+	std::vector<StringColumn> parts(bounds.size() - 1);
+
+	runParts(bounds, [this, &parts, &needle, &substitute]
+					 (size_t part, size_t start, size_t end)
+	{
+		StringColumn& replaced = parts[part];
+		replaced.reserve(end - start,
+						 this->offsets[end] - this->offsets[start]);
+
+		for (size_t idx = start; idx < end; idx++)
+		{
+			StringView value = (*this)[idx];
+			size_t prevIndex = 0;
+			size_t found = value.indexOf(needle);
+
+			// Copies every segment between matches straight into the arena,
+			// followed by the replacement
+			while (found != StringView::npos)
+			{
+				replaced.arena.insert(replaced.arena.end(),
+						value.data() + prevIndex, value.data() + found);
+				replaced.arena.insert(replaced.arena.end(),
+						substitute.data(),
+						substitute.data() + substitute.length());
+
+				prevIndex = found + needle.length();
+				found = value.indexOf(needle, prevIndex);
+			}
+
+			replaced.append(value.subview(prevIndex, value.length()));
+		}
+	});
+
+	StringColumn replaced;
+	for (size_t part = 0; part < parts.size(); part++)
+	{
+		replaced.appendColumn(parts[part]);
+	}
+
+	return replaced;
+}
+
+std::vector<unsigned long long> StringColumn::hash(unsigned int threads) const
+{
+	std::vector<unsigned long long> hashes(this->size());
+	std::vector<size_t> bounds = partition(this->size(), threads, 1);
+
+	runParts(bounds, [this, &hashes](size_t, size_t start, size_t end)
+	{
+		for (size_t idx = start; idx < end; idx++)
+		{
+			StringView value = (*this)[idx];
+
+			unsigned long long fnv = 14695981039346656037ULL;
+			for (size_t charIdx = 0; charIdx < value.length(); charIdx++)
+			{
+				fnv ^= static_cast<unsigned char>(value[charIdx]);
+				fnv *= 1099511628211ULL;
+			}
+
+			hashes[idx] = fnv;
+		}
+	});
+
+	return hashes;
+}
+
+bool StringColumn::isSet(const std::vector<unsigned char>& bitmap, size_t idx)
+{
+	return (bitmap[idx / 8] >> (idx % 8)) & 1;
+}
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+void StringColumn::appendColumn(const StringColumn& other)
+{
+	const size_t base = this->arena.size();
+
+	this->arena.insert(this->arena.end(),
+					   other.arena.begin(), other.arena.end());
+	for (size_t idx = 1; idx < other.offsets.size(); idx++)
+	{
+		this->offsets.push_back(base + other.offsets[idx]);
+	}
+}
+
+const StringColumn StringColumn::convertCase(int (*convert)(int),
+											 unsigned int threads) const
+{
+	// Converting through a lookup table lets the loop below run over the
+	// whole arena without a function call per character
+	unsigned char table[256];
+	for (int c = 0; c < 256; c++)
+	{
+		table[c] = static_cast<unsigned char>(convert(c));
+	}
+
+	// Case conversion never changes a value's length, so the offsets are
+	// shared and the arena may be split at any character
+	StringColumn converted;
+	converted.offsets = this->offsets;
+	converted.arena.resize(this->arena.size());
+
+	std::vector<size_t> bounds = partition(this->arena.size(), threads, 1);
+
+	runParts(bounds, [this, &converted, &table]
+					 (size_t, size_t start, size_t end)
+	{
+		for (size_t idx = start; idx < end; idx++)
+		{
+			converted.arena[idx] = static_cast<char>(
+					table[static_cast<unsigned char>(this->arena[idx])]);
+		}
+	});
+
+	return converted;
+}
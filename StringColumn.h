@@ -0,0 +1,188 @@
+
+#ifndef STRINGCOLUMN_H_
+#define STRINGCOLUMN_H_
+
+#include "String.h"
+#include "StringView.h"
+
+#include <vector>
+
+/**
+ * This class stores a whole column of Strings inside of one contiguous block
+ * of characters. Each value is located through an offsets array, where value
+ * i spans the characters between offsets[i] (inclusive) and offsets[i + 1]
+ * (exclusive).
+ *
+ * The batch methods apply a String operation to every value at once. They
+ * work over the shared block of characters rather than allocating a String
+ * per value, and may split the work across several threads.
+ *
+ * Like String, a StringColumn is largely immutable. The batch methods create
+ * a new StringColumn rather than changing the original.
+ */
+class StringColumn
+{
+
+public:
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates an empty StringColumn.
+	 */
+	StringColumn();
+
+	/**
+	 * Creates a StringColumn holding a copy of each of the given Strings, such
+	 * as the segments returned by String::split.
+	 *
+	 * @param values The Strings to be stored
+	 */
+	explicit StringColumn(const std::vector<String>& values);
+
+// -----------------------------------------------------------------------------
+// Column Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The total number of values in the column.
+	 */
+	const size_t size() const;
+
+	/**
+	 * @return The total number of characters across every value.
+	 */
+	const size_t byteLength() const;
+
+	/**
+	 * The returned view remains valid until this column is changed or
+	 * destroyed.
+	 *
+	 * @param idx An integer between 0 and the size of the column
+	 * @return A view of the value at the given index location
+	 */
+	const StringView operator[](size_t idx) const;
+
+	/**
+	 * @param idx An integer between 0 and the size of the column
+	 * @return A copy of the value at the given index location
+	 */
+	const String at(size_t idx) const;
+
+	/**
+	 * @return A copy of every value in the column
+	 */
+	std::vector<String> toVector() const;
+
+	/**
+	 * Appends a copy of the given characters as a new value at the end of the
+	 * column.
+	 *
+	 * @param value The value to be appended
+	 */
+	void append(const StringView& value);
+
+	/**
+	 * Reserves room for the given number of values and characters so that
+	 * appending them does not re-allocate.
+	 *
+	 * @param values The expected number of values
+	 * @param bytes The expected number of characters across every value
+	 */
+	void reserve(size_t values, size_t bytes);
+
+// -----------------------------------------------------------------------------
+// Batch Operations
+// -----------------------------------------------------------------------------
+//
+// Each batch operation takes the number of threads to split the work across.
+// A value of 1 runs on the calling thread, while 0 uses one thread per
+// hardware core. Small columns are always processed on the calling thread.
+
+	/**
+	 * Applies String::trim to every value.
+	 *
+	 * @param threads The number of threads to use
+	 * @return A new StringColumn whose values have been trimmed
+	 */
+	const StringColumn trim(unsigned int threads = 1) const;
+
+	/**
+	 * Applies String::toUppercase to every value.
+	 *
+	 * @param threads The number of threads to use
+	 * @return A new StringColumn whose values have been uppercased
+	 */
+	const StringColumn toUppercase(unsigned int threads = 1) const;
+
+	/**
+	 * Applies String::toLowercase to every value.
+	 *
+	 * @param threads The number of threads to use
+	 * @return A new StringColumn whose values have been lowercased
+	 */
+	const StringColumn toLowercase(unsigned int threads = 1) const;
+
+	/**
+	 * Applies String::contains to every value and packs the results into a
+	 * bitmap. The result of value i is stored in bit (i % 8) of byte (i / 8),
+	 * with the least significant bit first. See isSet.
+	 *
+	 * @param segment The String to be found within each value
+	 * @param threads The number of threads to use
+	 * @return The bitmap of matching values
+	 */
+	std::vector<unsigned char> contains(const StringView& segment,
+										unsigned int threads = 1) const;
+
+	/**
+	 * Applies String::replaceAll to every value.
+	 *
+	 * @param toReplace The String(s) to be replaced
+	 * @param replacement The replacement
+	 * @param threads The number of threads to use
+	 * @return A new StringColumn
+	 */
+	const StringColumn replaceAll(const String& toReplace,
+								  const String& replacement,
+								  unsigned int threads = 1) const;
+
+	/**
+	 * Hashes every value using 64-bit FNV-1a. Equal values always produce
+	 * equal hashes.
+	 *
+	 * @param threads The number of threads to use
+	 * @return The hash of each value, in order
+	 */
+	std::vector<unsigned long long> hash(unsigned int threads = 1) const;
+
+	/**
+	 * @param bitmap A bitmap returned by contains
+	 * @param idx The index location of the value
+	 * @return Whether the bit of the given value is set
+	 */
+	static bool isSet(const std::vector<unsigned char>& bitmap, size_t idx);
+
+private:
+
+	/**
+	 * Appends every value of the given column onto the end of this column.
+	 */
+	void appendColumn(const StringColumn& other);
+
+	/**
+	 * Applies the given character conversion to every character at once.
+	 */
+	const StringColumn convertCase(int (*convert)(int),
+								   unsigned int threads) const;
+
+	std::vector<char> arena;     // Stores the characters of every value
+	std::vector<size_t> offsets; // Marks where each value starts and ends
+
+};
+
+
+
+#endif
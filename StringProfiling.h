@@ -0,0 +1,35 @@
+
+#ifndef STRINGPROFILING_H_
+#define STRINGPROFILING_H_
+
+// The macros the String methods use to report their calls, allocations and
+// copies to StringStats. Without STRING_INSTRUMENTATION they expand to nothing
+// and StringStats, which needs C++11, is not even included, so String.h still
+// compiles as C++98.
+
+#ifdef STRING_INSTRUMENTATION
+
+#include "StringStats.h"
+
+/**
+ * Counts a call to the enclosing method under the given name and charges
+ * everything it does until it returns to that name.
+ */
+#define STRING_PROFILE(name) \
+	static StringStats::Method stringStatsMethod(name); \
+	StringStats::Scope stringStatsScope(stringStatsMethod)
+
+#define STRING_COUNT_ALLOC(bytes) StringStats::countAllocation(bytes)
+#define STRING_COUNT_COPY(bytes) StringStats::countCopy(bytes)
+
+#else
+
+#define STRING_PROFILE(name) ((void) 0)
+#define STRING_COUNT_ALLOC(bytes) ((void) 0)
+#define STRING_COUNT_COPY(bytes) ((void) 0)
+
+#endif
+
+
+
+#endif
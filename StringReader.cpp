@@ -0,0 +1,211 @@
+
+#include "StringReader.h"
+#include "StringWriter.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STRINGREADER_MMAP
+#endif
+
+/**
+ * Reads a 32-bit little endian integer.
+ */
+static size_t readUint32(const char* bytes)
+{
+	const unsigned char* digits = reinterpret_cast<const unsigned char*>(bytes);
+
+	return static_cast<size_t>(digits[0]) |
+		   (static_cast<size_t>(digits[1]) << 8) |
+		   (static_cast<size_t>(digits[2]) << 16) |
+		   (static_cast<size_t>(digits[3]) << 24);
+}
+
+StringReader::StringReader(const char* path)
+	: bytes(NULL), length(0), mappedLength(0), characters(0)
+{
+#if defined(STRINGREADER_MMAP)
+	int file = ::open(path, O_RDONLY);
+	if (file < 0) throw std::runtime_error("The file could not be opened");
+
+	struct stat status;
+	if (::fstat(file, &status) != 0)
+	{
+		::close(file);
+		throw std::runtime_error("The file could not be read");
+	}
+
+	// An empty file cannot be mapped, and is rejected by index anyway
+	if (status.st_size > 0)
+	{
+		void* mapped = ::mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE,
+							  file, 0);
+		if (mapped != MAP_FAILED)
+		{
+			// Every String is visited in order while indexing
+			::madvise(mapped, status.st_size, MADV_SEQUENTIAL);
+
+			this->bytes = static_cast<const char*>(mapped);
+			this->length = status.st_size;
+			this->mappedLength = status.st_size;
+		}
+	}
+	::close(file);
+#endif
+
+	// Reads the whole file in one go where it could not be mapped
+	if (this->mappedLength == 0)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file) throw std::runtime_error("The file could not be opened");
+
+		file.seekg(0, std::ios::end);
+		const std::streamoff size = file.tellg();
+		if (size < 0) throw std::runtime_error("The file could not be read");
+
+		this->buffer.resize(static_cast<size_t>(size));
+		file.seekg(0, std::ios::beg);
+
+		if (!this->buffer.empty() &&
+			!file.read(&this->buffer[0], this->buffer.size()))
+		{
+			throw std::runtime_error("The file could not be read");
+		}
+
+		this->bytes = this->buffer.empty() ? NULL : &this->buffer[0];
+		this->length = this->buffer.size();
+	}
+
+	try
+	{
+		this->index();
+	}
+	catch (...)
+	{
+		// The destructor does not run when a constructor throws
+		this->unmap();
+		throw;
+	}
+}
+
+StringReader::StringReader(const char* bytes, size_t length)
+	: bytes(bytes), length(length), mappedLength(0), characters(0)
+{
+	this->index();
+}
+
+StringReader::~StringReader()
+{
+	this->unmap();
+}
+
+// -----------------------------------------------------------------------------
+// Reader Information
+// -----------------------------------------------------------------------------
+
+const size_t StringReader::size() const
+{
+	return this->starts.size();
+}
+
+const size_t StringReader::byteLength() const
+{
+	return this->characters;
+}
+
+const StringView StringReader::operator[](size_t idx) const
+{
+	const char* start = this->bytes + this->starts[idx];
+
+	return StringView(start, readUint32(start - StringWriter::LENGTH_SIZE));
+}
+
+// -----------------------------------------------------------------------------
+// Copying
+// -----------------------------------------------------------------------------
+
+const StringColumn StringReader::toColumn() const
+{
+	StringColumn column;
+	column.reserve(this->size(), this->characters);
+
+	for (size_t idx = 0; idx < this->size(); idx++)
+	{
+		column.append((*this)[idx]);
+	}
+
+	return column;
+}
+
+std::vector<String> StringReader::toVector() const
+{
+	std::vector<String> values;
+	values.reserve(this->size());
+
+	for (size_t idx = 0; idx < this->size(); idx++)
+	{
+		const StringView value = (*this)[idx];
+		values.push_back(String(value.data(), value.length()));
+	}
+
+	return values;
+}
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+void StringReader::index()
+{
+	if (this->length < StringWriter::HEADER_SIZE ||
+		std::memcmp(this->bytes, StringWriter::MAGIC,
+					sizeof(StringWriter::MAGIC)) != 0)
+	{
+		throw std::invalid_argument(
+				"The bytes were not written by StringWriter");
+	}
+
+	if (readUint32(this->bytes + sizeof(StringWriter::MAGIC)) !=
+		StringWriter::VERSION)
+	{
+		throw std::invalid_argument("The format version is not supported");
+	}
+
+	size_t position = StringWriter::HEADER_SIZE;
+	while (position < this->length)
+	{
+		if (this->length - position < StringWriter::LENGTH_SIZE)
+		{
+			throw std::invalid_argument("The last String's length is cut off");
+		}
+
+		const size_t count = readUint32(this->bytes + position);
+		position += StringWriter::LENGTH_SIZE;
+
+		if (this->length - position < count)
+		{
+			throw std::invalid_argument("The last String is cut off");
+		}
+
+		this->starts.push_back(position);
+		this->characters += count;
+		position += count;
+	}
+}
+
+void StringReader::unmap()
+{
+#if defined(STRINGREADER_MMAP)
+	if (this->mappedLength > 0)
+	{
+		::munmap(const_cast<char*>(this->bytes), this->mappedLength);
+		this->mappedLength = 0;
+	}
+#endif
+}
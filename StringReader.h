@@ -0,0 +1,124 @@
+
+#ifndef STRINGREADER_H_
+#define STRINGREADER_H_
+
+#include "String.h"
+#include "StringColumn.h"
+#include "StringView.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * This class loads a list of Strings written by StringWriter. A file is
+ * memory mapped where the platform allows it (and read in one go where it
+ * does not), so opening even a very large file only walks the length of each
+ * String once to find where it begins. Each String can then be viewed in
+ * place without being copied, or the whole list can be copied into a
+ * StringColumn with a single allocation for all of the characters.
+ *
+ * Every StringView returned is only valid for as long as the StringReader
+ * exists.
+ *
+ * @example
+ * StringReader reader("tokens.strb");
+ * for (size_t idx = 0; idx < reader.size(); idx++)
+ * {
+ * 		reader[idx]; // A StringView straight into the file
+ * }
+ * StringColumn column = reader.toColumn();
+ */
+class StringReader
+{
+
+public:
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Opens the file at the given path.
+	 *
+	 * @param path The path of the file written by StringWriter
+	 * @throws std::runtime_error If the file could not be opened or read
+	 * @throws std::invalid_argument If the file is not in the expected format
+	 */
+	explicit StringReader(const char* path);
+
+	/**
+	 * Reads from the given bytes, which must remain unchanged and allocated
+	 * for as long as the StringReader exists.
+	 *
+	 * @param bytes The bytes written by StringWriter
+	 * @param length The number of bytes
+	 * @throws std::invalid_argument If the bytes are not in the expected format
+	 */
+	StringReader(const char* bytes, size_t length);
+
+	/**
+	 * Destructs the StringReader, unmapping the file if there is one.
+	 */
+	~StringReader();
+
+// -----------------------------------------------------------------------------
+// Reader Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The total number of Strings.
+	 */
+	const size_t size() const;
+
+	/**
+	 * @return The total number of characters across every String.
+	 */
+	const size_t byteLength() const;
+
+	/**
+	 * @param idx The index location of the String
+	 * @return A view of the String at the given index location
+	 */
+	const StringView operator[](size_t idx) const;
+
+// -----------------------------------------------------------------------------
+// Copying
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return A StringColumn holding a copy of every String
+	 */
+	const StringColumn toColumn() const;
+
+	/**
+	 * @return A copy of every String
+	 */
+	std::vector<String> toVector() const;
+
+private:
+	StringReader(const StringReader&);
+	StringReader& operator=(const StringReader&);
+
+	/**
+	 * Checks the header and finds where each String begins.
+	 */
+	void index();
+
+	/**
+	 * Releases the memory mapped file, if there is one.
+	 */
+	void unmap();
+
+	const char* bytes;            // Everything in the format, header included
+	size_t length;                // The number of bytes
+	size_t mappedLength;          // The length of the mapping, or 0 if none
+	std::vector<char> buffer;     // Holds the file if it could not be mapped
+
+	std::vector<size_t> starts;   // Where each String's characters begin
+	size_t characters;            // The total number of characters
+
+};
+
+
+
+#endif
@@ -0,0 +1,204 @@
+
+#include "StringStats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The deepest nesting of methods which is kept track of; methods called
+// any deeper are still counted but are not charged for what they do
+static const size_t MAX_DEPTH = 32;
+
+// The methods currently running on this thread, outermost first
+static thread_local StringStats::Method* running[MAX_DEPTH];
+static thread_local size_t depth = 0;
+
+// Every method which has been registered, most recent first
+static StringStats::Method* firstMethod = NULL;
+static std::mutex registryMutex;
+
+/**
+ * Adds the given amount to the chosen count of every running method. A
+ * method which is running more than once is only charged once.
+ */
+static void charge(std::atomic<unsigned long long> StringStats::Method::*count,
+				   unsigned long long amount)
+{
+	for (size_t level = 0; level < depth; level++)
+	{
+		bool repeated = false;
+		for (size_t outer = 0; outer < level && !repeated; outer++)
+		{
+			repeated = running[outer] == running[level];
+		}
+
+		if (!repeated) (running[level]->*count) += amount;
+	}
+}
+
+// The counts reported for one method name. Each instantiation of a template
+// method has its own Method, so these are added together under one name.
+struct Totals
+{
+	std::string name;
+	unsigned long long calls;
+	unsigned long long allocations;
+	unsigned long long allocatedBytes;
+	unsigned long long copiedBytes;
+};
+
+/**
+ * @return Whether the first method made more allocations than the second
+ */
+static bool moreAllocations(const Totals& first, const Totals& second)
+{
+	return first.allocations > second.allocations;
+}
+
+/**
+ * @return The totals for every method which has been called at least once,
+ * 		   ordered by the number of allocations made
+ */
+static std::vector<Totals> calledMethods()
+{
+	std::vector<Totals> methods;
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (StringStats::Method* method = firstMethod; method != NULL;
+		 method = method->nextMethod)
+	{
+		if (method->calls == 0) continue;
+
+		size_t idx = 0;
+		while (idx < methods.size() && methods[idx].name != method->name) idx++;
+
+		if (idx == methods.size())
+		{
+			Totals totals = { method->name, 0, 0, 0, 0 };
+			methods.push_back(totals);
+		}
+
+		methods[idx].calls += method->calls;
+		methods[idx].allocations += method->allocations;
+		methods[idx].allocatedBytes += method->allocatedBytes;
+		methods[idx].copiedBytes += method->copiedBytes;
+	}
+
+	std::stable_sort(methods.begin(), methods.end(), moreAllocations);
+
+	return methods;
+}
+
+StringStats::Method::Method(const char* name)
+	: name(name), calls(0), allocations(0), allocatedBytes(0), copiedBytes(0),
+	  nextMethod(NULL)
+{
+	StringStats::registerMethod(this);
+}
+
+StringStats::Scope::Scope(Method& method)
+	: entered(false)
+{
+	++method.calls;
+
+	if (depth < MAX_DEPTH)
+	{
+		running[depth++] = &method;
+		this->entered = true;
+	}
+}
+
+StringStats::Scope::~Scope()
+{
+	if (this->entered) --depth;
+}
+
+// -----------------------------------------------------------------------------
+// Counting
+// -----------------------------------------------------------------------------
+
+void StringStats::countAllocation(size_t bytes)
+{
+	charge(&Method::allocations, 1);
+	charge(&Method::allocatedBytes, bytes);
+}
+
+void StringStats::countCopy(size_t bytes)
+{
+	charge(&Method::copiedBytes, bytes);
+}
+
+// -----------------------------------------------------------------------------
+// Reporting
+// -----------------------------------------------------------------------------
+
+void StringStats::report(std::ostream& os)
+{
+	std::vector<Totals> methods = calledMethods();
+
+	// Wide enough for the longest name plus a gap before the first count
+	size_t nameWidth = 8;
+	for (size_t idx = 0; idx < methods.size(); idx++)
+	{
+		nameWidth = std::max(nameWidth, methods[idx].name.length() + 2);
+	}
+
+	os << std::left << std::setw(nameWidth) << "Method" << std::right
+	   << std::setw(14) << "Calls"
+	   << std::setw(14) << "Allocations"
+	   << std::setw(18) << "Allocated Bytes"
+	   << std::setw(16) << "Copied Bytes" << std::endl;
+
+	for (size_t idx = 0; idx < methods.size(); idx++)
+	{
+		const Totals& method = methods[idx];
+
+		os << std::left << std::setw(nameWidth) << method.name << std::right
+		   << std::setw(14) << method.calls
+		   << std::setw(14) << method.allocations
+		   << std::setw(18) << method.allocatedBytes
+		   << std::setw(16) << method.copiedBytes << std::endl;
+	}
+}
+
+void StringStats::writeJson(std::ostream& os)
+{
+	std::vector<Totals> methods = calledMethods();
+
+	os << "[";
+	for (size_t idx = 0; idx < methods.size(); idx++)
+	{
+		if (idx > 0) os << ",";
+
+		// Method names never contain quotes or backslashes to be escaped
+		os << "{\"method\":\"" << methods[idx].name << "\""
+		   << ",\"calls\":" << methods[idx].calls
+		   << ",\"allocations\":" << methods[idx].allocations
+		   << ",\"allocatedBytes\":" << methods[idx].allocatedBytes
+		   << ",\"copiedBytes\":" << methods[idx].copiedBytes << "}";
+	}
+	os << "]";
+}
+
+void StringStats::reset()
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for (Method* method = firstMethod; method != NULL;
+		 method = method->nextMethod)
+	{
+		method->calls = 0;
+		method->allocations = 0;
+		method->allocatedBytes = 0;
+		method->copiedBytes = 0;
+	}
+}
+
+void StringStats::registerMethod(Method* method)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	method->nextMethod = firstMethod;
+	firstMethod = method;
+}
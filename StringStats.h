@@ -0,0 +1,129 @@
+
+#ifndef STRINGSTATS_H_
+#define STRINGSTATS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+
+/**
+ * This class counts how often each String method is called, along with how
+ * many allocations it makes and how many bytes it copies. The counts include
+ * everything done by the other methods it calls, so a method which builds
+ * temporary Strings is charged for each of them.
+ *
+ * Counting only happens when the project is compiled with
+ * STRING_INSTRUMENTATION defined (such as with -DSTRING_INSTRUMENTATION).
+ * Otherwise the STRING_* macros in StringProfiling.h expand to nothing and
+ * this header is not included by String.h at all.
+ *
+ * @example
+ * // After running the code being measured
+ * StringStats::report(std::cout);
+ * StringStats::writeJson(logFile);
+ */
+class StringStats
+{
+
+public:
+
+	/**
+	 * The counts kept for a single method. One of these is created the first
+	 * time each instrumented method is called.
+	 */
+	class Method
+	{
+
+	public:
+
+		/**
+		 * @param name The name reported for the method
+		 */
+		Method(const char* name);
+
+		const char* name;
+		std::atomic<unsigned long long> calls;
+		std::atomic<unsigned long long> allocations;
+		std::atomic<unsigned long long> allocatedBytes;
+		std::atomic<unsigned long long> copiedBytes;
+
+		Method* nextMethod; // The method registered before this one
+
+	};
+
+	/**
+	 * Marks a method as running for as long as the Scope exists, so that any
+	 * allocations and copies made in the meantime are charged to it.
+	 */
+	class Scope
+	{
+
+	public:
+
+		Scope(Method& method);
+		~Scope();
+
+	private:
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+		bool entered; // Whether the method was added to the running methods
+
+	};
+
+// -----------------------------------------------------------------------------
+// Counting
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Charges an allocation of the given size to every running method.
+	 *
+	 * @param bytes The number of bytes allocated
+	 */
+	static void countAllocation(size_t bytes);
+
+	/**
+	 * Charges a copy of the given size to every running method.
+	 *
+	 * @param bytes The number of bytes copied
+	 */
+	static void countCopy(size_t bytes);
+
+// -----------------------------------------------------------------------------
+// Reporting
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Writes a table of every method which has been called, ordered by the
+	 * number of allocations it made.
+	 *
+	 * @param os The output stream
+	 */
+	static void report(std::ostream& os);
+
+	/**
+	 * Writes the same counts as report as a JSON array of objects, each with
+	 * the fields "method", "calls", "allocations", "allocatedBytes" and
+	 * "copiedBytes".
+	 *
+	 * @param os The output stream
+	 */
+	static void writeJson(std::ostream& os);
+
+	/**
+	 * Sets every count back to zero.
+	 */
+	static void reset();
+
+private:
+
+	/**
+	 * Adds the given method to the list of methods which are reported.
+	 */
+	static void registerMethod(Method* method);
+
+};
+
+
+
+#endif
@@ -0,0 +1,103 @@
+
+#include "StringView.h"
+#include "String.h"
+
+#include <cstring>
+
+const size_t StringView::npos;
+
+StringView::StringView()
+	: chars(""), count(0)
+{
+}
+
+StringView::StringView(const char* c_str)
+	: chars(c_str), count(std::strlen(c_str))
+{
+}
+
+StringView::StringView(const String& str)
+	: chars(str.c_str), count(std::strlen(str.c_str))
+{
+}
+
+// -----------------------------------------------------------------------------
+// View Information
+// -----------------------------------------------------------------------------
+
+const char* StringView::data() const
+{
+	return this->chars;
+}
+
+const size_t StringView::length() const
+{
+	return this->count;
+}
+
+const char StringView::operator[](size_t idx) const
+{
+	return this->chars[idx];
+}
+
+const size_t StringView::indexOf(const StringView& segment,
+								 size_t fromIdx) const
+{
+	if (fromIdx > this->count) return npos;
+	if (segment.count == 0) return fromIdx;
+	if (segment.count > this->count - fromIdx) return npos;
+
+	// The last index location where a full match could still begin
+	const char* last = this->chars + (this->count - segment.count);
+	const char* sentry = this->chars + fromIdx;
+	const char first = segment.chars[0];
+
+	while (sentry <= last)
+	{
+		// Jumps straight to the next occurrence of the segment's first
+		// character and only then compares the remaining characters
+		sentry = static_cast<const char*>(
+				std::memchr(sentry, first, (last - sentry) + 1));
+		if (sentry == NULL) return npos;
+
+		if (std::memcmp(sentry + 1, segment.chars + 1, segment.count - 1) == 0)
+		{
+			return sentry - this->chars;
+		}
+		++sentry;
+	}
+
+	return npos;
+}
+
+const StringView StringView::subview(size_t startIdx, size_t endIdx) const
+{
+	return StringView(this->chars + startIdx, endIdx - startIdx);
+}
+
+const String StringView::toString() const
+{
+	return String(this->chars, this->count);
+}
+
+// -----------------------------------------------------------------------------
+// Comparison Operators
+// -----------------------------------------------------------------------------
+
+bool StringView::operator==(const StringView& toCompare) const
+{
+	return this->count == toCompare.count &&
+		   std::memcmp(this->chars, toCompare.chars, this->count) == 0;
+}
+
+bool StringView::operator!=(const StringView& toCompare) const
+{
+	return !(this->operator ==(toCompare));
+}
+
+std::ostream& operator<<(std::ostream& os, const StringView& view)
+{
+	os.write(view.chars, view.count);
+
+	return os;
+}
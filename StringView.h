@@ -0,0 +1,133 @@
+
+#ifndef STRINGVIEW_H_
+#define STRINGVIEW_H_
+
+#include <cstddef>
+#include <iostream>
+
+// FixedString builds StringViews at compile time, which needs C++11. Older
+// code including String.h still compiles, just without the constexpr.
+#if __cplusplus >= 201103L
+#define STRINGVIEW_CONSTEXPR constexpr
+#else
+#define STRINGVIEW_CONSTEXPR
+#endif
+
+class String;
+
+/**
+ * This class refers to a series of characters owned by some other object
+ * without copying them. The characters are not required to end with a null
+ * terminating byte.
+ *
+ * A StringView is only valid for as long as the characters it refers to
+ * remain unchanged and allocated.
+ */
+class StringView
+{
+
+public:
+
+	/**
+	 * Returned by the search methods when nothing was found.
+	 */
+	static const size_t npos = static_cast<size_t>(-1);
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates an empty StringView.
+	 */
+	StringView();
+
+	/**
+	 * Creates a StringView referring to the given characters.
+	 *
+	 * @param chars The first character being referred to
+	 * @param length The number of characters being referred to
+	 */
+	STRINGVIEW_CONSTEXPR StringView(const char* chars, size_t length)
+		: chars(chars), count(length)
+	{
+	}
+
+	/**
+	 * Creates a StringView referring to the given null terminated characters,
+	 * not including the null terminating byte.
+	 *
+	 * @param c_str The characters being referred to
+	 */
+	StringView(const char* c_str);
+
+	/**
+	 * Creates a StringView referring to every character of the given String.
+	 *
+	 * @param str The String being referred to
+	 */
+	StringView(const String& str);
+
+// -----------------------------------------------------------------------------
+// View Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The first character being referred to
+	 */
+	const char* data() const;
+
+	/**
+	 * @return The total number of characters in the view.
+	 */
+	const size_t length() const;
+
+	/**
+	 * @param idx An integer between 0 and the length of the view
+	 * @return The character at the given index location
+	 */
+	const char operator[](size_t idx) const;
+
+	/**
+	 * Finds the first occurrence of the given segment at or after the given
+	 * index location.
+	 *
+	 * @param segment The characters to be found within this view
+	 * @param fromIdx The index location where the search begins
+	 * @return The index location of the first matching character;
+	 * 		   Will return npos if no index was found
+	 */
+	const size_t indexOf(const StringView& segment, size_t fromIdx = 0) const;
+
+	/**
+	 * @param startIdx The first character to be included
+	 * @param endIdx The character AFTER the last character to be included
+	 * @return A view referring to the given segment of this view
+	 */
+	const StringView subview(size_t startIdx, size_t endIdx) const;
+
+	/**
+	 * Copies the characters being referred to into a new String.
+	 *
+	 * @return The resulting String
+	 */
+	const String toString() const;
+
+// -----------------------------------------------------------------------------
+// Comparison Operators
+// -----------------------------------------------------------------------------
+
+	bool operator==(const StringView& toCompare) const;
+	bool operator!=(const StringView& toCompare) const;
+
+	friend std::ostream& operator<<(std::ostream& os, const StringView& view);
+
+private:
+	const char* chars; // The first character referred to; never owned
+	size_t count;      // The number of characters referred to
+
+};
+
+
+
+#endif
@@ -0,0 +1,129 @@
+
+#include "StringWriter.h"
+
+#include <cstring>
+#include <stdexcept>
+
+const char StringWriter::MAGIC[4] = { 'S', 'T', 'R', 'B' };
+const unsigned int StringWriter::VERSION;
+const size_t StringWriter::HEADER_SIZE;
+const size_t StringWriter::LENGTH_SIZE;
+
+// The size of the blocks passed on to the stream
+static const size_t BUFFER_SIZE = 64 * 1024;
+
+/**
+ * Encodes the given number as a 32-bit little endian integer.
+ */
+static void encodeUint32(unsigned long number, char* bytes)
+{
+	bytes[0] = static_cast<char>(number & 0xFF);
+	bytes[1] = static_cast<char>((number >> 8) & 0xFF);
+	bytes[2] = static_cast<char>((number >> 16) & 0xFF);
+	bytes[3] = static_cast<char>((number >> 24) & 0xFF);
+}
+
+StringWriter::StringWriter(std::ostream& os)
+	: os(&os), written(0)
+{
+	this->pending.reserve(BUFFER_SIZE);
+
+	char header[HEADER_SIZE];
+	std::memcpy(header, MAGIC, sizeof(MAGIC));
+	encodeUint32(VERSION, header + sizeof(MAGIC));
+
+	this->buffer(header, sizeof(header));
+}
+
+StringWriter::~StringWriter()
+{
+	// A destructor cannot throw, so a failure here goes unreported; Calling
+	// flush beforehand is the way to find out about it
+	try
+	{
+		this->flush();
+	}
+	catch (const std::runtime_error&)
+	{
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writer Information
+// -----------------------------------------------------------------------------
+
+const unsigned long long StringWriter::count() const
+{
+	return this->written;
+}
+
+// -----------------------------------------------------------------------------
+// Writing
+// -----------------------------------------------------------------------------
+
+void StringWriter::write(const StringView& value)
+{
+	if (value.length() > 0xFFFFFFFFUL)
+	{
+		throw std::length_error("The String is too long to be written");
+	}
+
+	char prefix[LENGTH_SIZE];
+	encodeUint32(static_cast<unsigned long>(value.length()), prefix);
+
+	this->buffer(prefix, sizeof(prefix));
+	this->buffer(value.data(), value.length());
+
+	++this->written;
+}
+
+void StringWriter::write(const StringColumn& column)
+{
+	for (size_t idx = 0; idx < column.size(); idx++)
+	{
+		this->write(column[idx]);
+	}
+}
+
+void StringWriter::flush()
+{
+	if (!this->pending.empty())
+	{
+		this->os->write(&this->pending[0], this->pending.size());
+
+		// The buffer is emptied even if the stream failed, so that the same
+		// bytes are not written again by the destructor
+		this->pending.clear();
+		this->checkStream();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+void StringWriter::buffer(const char* bytes, size_t count)
+{
+	if (this->pending.size() + count > BUFFER_SIZE)
+	{
+		this->flush();
+
+		// Anything too big for the buffer goes straight to the stream
+		if (count > BUFFER_SIZE)
+		{
+			this->os->write(bytes, count);
+			this->checkStream();
+			return;
+		}
+	}
+
+	this->pending.insert(this->pending.end(), bytes, bytes + count);
+}
+
+void StringWriter::checkStream() const
+{
+	if (!this->os->good())
+	{
+		throw std::runtime_error("The stream could not be written to");
+	}
+}
@@ -0,0 +1,150 @@
+
+#ifndef STRINGWRITER_H_
+#define STRINGWRITER_H_
+
+#include "String.h"
+#include "StringColumn.h"
+#include "StringView.h"
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+/**
+ * This class writes a list of Strings to a stream in a compact binary format
+ * which StringReader can load back without parsing or copying each String.
+ *
+ * The format is a header of the four bytes "STRB" followed by the version
+ * number as a 32-bit little endian integer. Each String then follows as its
+ * length in bytes (a 32-bit little endian integer) and its characters, with
+ * no null terminating byte. There is no count up front, so Strings can be
+ * written as they are produced; the list ends where the stream ends.
+ *
+ * Small Strings are gathered into a buffer and passed to the stream in large
+ * blocks. Everything has been passed on once flush is called or the
+ * StringWriter is destructed. The stream is checked after every block, and a
+ * stream which failed is reported as a std::runtime_error. The destructor
+ * cannot report a failure, so flush should be called once writing is done.
+ *
+ * @example
+ * std::ofstream file("tokens.strb", std::ios::binary);
+ * StringWriter writer(file);
+ * std::vector<String> tokens = line.split(" ");
+ * writer.write(tokens.begin(), tokens.end());
+ */
+class StringWriter
+{
+
+public:
+
+	/**
+	 * The first bytes of every file in this format.
+	 */
+	static const char MAGIC[4];
+
+	/**
+	 * The version of the format written.
+	 */
+	static const unsigned int VERSION = 1;
+
+	/**
+	 * The size of the header, and of the length written before each String.
+	 */
+	static const size_t HEADER_SIZE = 8;
+	static const size_t LENGTH_SIZE = 4;
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates a StringWriter and writes the header to the given stream, which
+	 * should have been opened in binary mode.
+	 *
+	 * @param os The stream written to. It must outlive this StringWriter.
+	 */
+	explicit StringWriter(std::ostream& os);
+
+	/**
+	 * Destructs the StringWriter after passing anything still buffered on to
+	 * the stream. Unlike flush, a failure to do so is not reported.
+	 */
+	~StringWriter();
+
+// -----------------------------------------------------------------------------
+// Writer Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The number of Strings written so far
+	 */
+	const unsigned long long count() const;
+
+// -----------------------------------------------------------------------------
+// Writing
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Writes a single String.
+	 *
+	 * @param value The String to be written
+	 * @throws std::length_error If the String is 4 GiB or longer
+	 * @throws std::runtime_error If the stream could not be written to
+	 */
+	void write(const StringView& value);
+
+	/**
+	 * Writes every value of the given StringColumn.
+	 *
+	 * @param column The values to be written
+	 * @throws std::runtime_error If the stream could not be written to
+	 */
+	void write(const StringColumn& column);
+
+	/**
+	 * Writes every String in the given range, such as a std::vector<String>.
+	 *
+	 * @param first The first String to be written
+	 * @param last The position after the last String to be written
+	 * @throws std::runtime_error If the stream could not be written to
+	 */
+	template <class Iterator>
+	void write(Iterator first, Iterator last)
+	{
+		for (; first != last; ++first)
+		{
+			this->write(StringView(*first));
+		}
+	}
+
+	/**
+	 * Passes everything written so far on to the stream.
+	 *
+	 * @throws std::runtime_error If the stream could not be written to
+	 */
+	void flush();
+
+private:
+	StringWriter(const StringWriter&);
+	StringWriter& operator=(const StringWriter&);
+
+	/**
+	 * Adds the given bytes to the buffer, flushing it first if they do not
+	 * fit.
+	 */
+	void buffer(const char* bytes, size_t count);
+
+	/**
+	 * @throws std::runtime_error If the stream has failed
+	 */
+	void checkStream() const;
+
+	std::ostream* os;
+	std::vector<char> pending;  // Written but not yet passed to the stream
+	unsigned long long written;
+
+};
+
+
+
+#endif
@@ -0,0 +1,311 @@
+
+#include "SymbolTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+const unsigned char SymbolTable::ESCAPE;
+const size_t SymbolTable::MAX_SYMBOL_LENGTH;
+
+// The most sample characters looked at while training
+static const size_t MAX_SAMPLE_LENGTH = 64 * 1024;
+
+// The number of rounds of training. Each round can at most double the length
+// of the symbols, so this is enough to reach MAX_SYMBOL_LENGTH with a round
+// to spare for choosing among them.
+static const size_t TRAINING_ROUNDS = 5;
+
+// While training, every character without a symbol is counted as its own
+// code after the 255 symbol codes
+static const size_t TRAINING_CODES = 255 + 256;
+
+/**
+ * @return Whether the first candidate saves more space than the second,
+ * 		   falling back to the order of their characters so that training
+ * 		   always picks the same symbols
+ */
+static bool moreGain(const std::pair<unsigned long long, std::string>& first,
+					 const std::pair<unsigned long long, std::string>& second)
+{
+	if (first.first != second.first) return first.first > second.first;
+
+	return first.second < second.second;
+}
+
+SymbolTable::SymbolTable()
+	: count(0)
+{
+}
+
+SymbolTable::SymbolTable(const std::vector<String>& samples)
+	: count(0)
+{
+	std::vector<StringView> views(samples.begin(), samples.end());
+	this->train(views);
+}
+
+SymbolTable::SymbolTable(const StringColumn& samples)
+	: count(0)
+{
+	std::vector<StringView> views;
+	views.reserve(samples.size());
+	for (size_t idx = 0; idx < samples.size(); idx++)
+	{
+		views.push_back(samples[idx]);
+	}
+
+	this->train(views);
+}
+
+// -----------------------------------------------------------------------------
+// Table Information
+// -----------------------------------------------------------------------------
+
+const size_t SymbolTable::size() const
+{
+	return this->count;
+}
+
+const StringView SymbolTable::symbol(unsigned char code) const
+{
+	if (code >= this->count)
+	{
+		throw std::out_of_range("The symbol code was out of bounds");
+	}
+
+	return StringView(reinterpret_cast<const char*>(&this->words[code]),
+					  this->lengths[code]);
+}
+
+// -----------------------------------------------------------------------------
+// Compressing
+// -----------------------------------------------------------------------------
+
+void SymbolTable::encode(const StringView& text,
+						 std::vector<unsigned char>& codes) const
+{
+	const char* chars = text.data();
+	const size_t length = text.length();
+
+	// Makes room for the worst case, where every character is escaped, so
+	// that codes can be written without checking for room each time
+	const size_t start = codes.size();
+	codes.resize(start + 2 * length);
+	unsigned char* sentry = codes.empty() ? NULL : &codes[start];
+
+	size_t idx = 0;
+	while (idx < length)
+	{
+		const unsigned char code =
+				this->longestMatch(chars + idx, length - idx);
+		*sentry++ = code;
+
+		if (code == ESCAPE) {
+			*sentry++ = static_cast<unsigned char>(chars[idx]);
+			++idx;
+		} else {
+			idx += this->lengths[code];
+		}
+	}
+
+	codes.resize(sentry == NULL ? start : sentry - &codes[0]);
+}
+
+size_t SymbolTable::decode(const unsigned char* codes, size_t count,
+						   char* output) const
+{
+	char* sentry = output;
+
+	for (size_t idx = 0; idx < count; idx++)
+	{
+		const unsigned char code = codes[idx];
+		if (code == ESCAPE) {
+			*sentry++ = static_cast<char>(codes[++idx]);
+		} else {
+			// Copies all eight bytes at once and then only advances by the
+			// symbol's length, which is why output needs room to spare
+			std::memcpy(sentry, &this->words[code], MAX_SYMBOL_LENGTH);
+			sentry += this->lengths[code];
+		}
+	}
+
+	return sentry - output;
+}
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+void SymbolTable::train(const std::vector<StringView>& samples)
+{
+	// Keeps only as many samples as fit within MAX_SAMPLE_LENGTH
+	std::vector<StringView> sample;
+	size_t sampleLength = 0;
+	for (size_t idx = 0; idx < samples.size(); idx++)
+	{
+		if (sampleLength >= MAX_SAMPLE_LENGTH) break;
+
+		const size_t kept = std::min(samples[idx].length(),
+									 MAX_SAMPLE_LENGTH - sampleLength);
+		sample.push_back(samples[idx].subview(0, kept));
+		sampleLength += kept;
+	}
+
+	std::vector<unsigned long long> singles(TRAINING_CODES);
+	std::vector<unsigned long long> pairs(TRAINING_CODES * TRAINING_CODES);
+
+	// Each round compresses the sample with the symbols chosen so far, then
+	// chooses new symbols out of the codes used most often along with the
+	// most common pairs of adjacent codes joined together
+	for (size_t round = 0; round < TRAINING_ROUNDS; round++)
+	{
+		std::fill(singles.begin(), singles.end(), 0);
+		std::fill(pairs.begin(), pairs.end(), 0);
+
+		for (size_t sampleIdx = 0; sampleIdx < sample.size(); sampleIdx++)
+		{
+			const char* chars = sample[sampleIdx].data();
+			const size_t length = sample[sampleIdx].length();
+
+			size_t previous = TRAINING_CODES; // No previous code yet
+			size_t idx = 0;
+			while (idx < length)
+			{
+				const unsigned char match =
+						this->longestMatch(chars + idx, length - idx);
+
+				size_t code;
+				if (match == ESCAPE) {
+					code = 255 + static_cast<unsigned char>(chars[idx]);
+					++idx;
+				} else {
+					code = match;
+					idx += this->lengths[match];
+				}
+
+				++singles[code];
+				if (previous != TRAINING_CODES)
+				{
+					++pairs[previous * TRAINING_CODES + code];
+				}
+				previous = code;
+			}
+		}
+
+		// Each candidate saves roughly one character for every character
+		// beyond the first that it covers, and escaping a lone character
+		// costs one extra, so gain is weighted by length
+		std::map<std::string, unsigned long long> gains;
+		for (size_t code = 0; code < TRAINING_CODES; code++)
+		{
+			if (singles[code] == 0) continue;
+
+			const std::string text = code < 255
+					? std::string(this->symbol(code).data(),
+								  this->symbol(code).length())
+					: std::string(1, static_cast<char>(code - 255));
+			gains[text] += singles[code] * text.length();
+
+			for (size_t next = 0; next < TRAINING_CODES; next++)
+			{
+				const unsigned long long frequency =
+						pairs[code * TRAINING_CODES + next];
+				if (frequency == 0) continue;
+
+				std::string joined = text + (next < 255
+						? std::string(this->symbol(next).data(),
+									  this->symbol(next).length())
+						: std::string(1, static_cast<char>(next - 255)));
+				if (joined.length() > MAX_SYMBOL_LENGTH)
+				{
+					joined.resize(MAX_SYMBOL_LENGTH);
+				}
+
+				gains[joined] += frequency * joined.length();
+			}
+		}
+
+		std::vector<std::pair<unsigned long long, std::string> > candidates;
+		candidates.reserve(gains.size());
+		for (std::map<std::string, unsigned long long>::const_iterator it =
+				gains.begin(); it != gains.end(); ++it)
+		{
+			candidates.push_back(std::make_pair(it->second, it->first));
+		}
+
+		const size_t chosen = std::min<size_t>(candidates.size(), 255);
+		std::partial_sort(candidates.begin(), candidates.begin() + chosen,
+						  candidates.end(), moreGain);
+
+		std::vector<std::string> symbols;
+		symbols.reserve(chosen);
+		for (size_t idx = 0; idx < chosen; idx++)
+		{
+			symbols.push_back(candidates[idx].second);
+		}
+
+		this->assign(symbols);
+	}
+}
+
+void SymbolTable::assign(const std::vector<std::string>& symbols)
+{
+	this->count = symbols.size();
+
+	for (size_t first = 0; first < 256; first++)
+	{
+		this->byFirstChar[first].clear();
+	}
+
+	for (size_t code = 0; code < this->count; code++)
+	{
+		this->words[code] = 0;
+		std::memcpy(&this->words[code], symbols[code].data(),
+					symbols[code].length());
+		this->lengths[code] =
+				static_cast<unsigned char>(symbols[code].length());
+
+		const unsigned char first = symbols[code][0];
+		this->byFirstChar[first].push_back(static_cast<unsigned char>(code));
+	}
+
+	// Orders each list longest first so that the first match is the longest
+	for (size_t first = 0; first < 256; first++)
+	{
+		std::vector<unsigned char>& codes = this->byFirstChar[first];
+		for (size_t idx = 1; idx < codes.size(); idx++)
+		{
+			const unsigned char code = codes[idx];
+
+			size_t slot = idx;
+			while (slot > 0 &&
+				   this->lengths[codes[slot - 1]] < this->lengths[code])
+			{
+				codes[slot] = codes[slot - 1];
+				--slot;
+			}
+			codes[slot] = code;
+		}
+	}
+}
+
+unsigned char SymbolTable::longestMatch(const char* text, size_t length) const
+{
+	const std::vector<unsigned char>& codes =
+			this->byFirstChar[static_cast<unsigned char>(text[0])];
+
+	for (size_t idx = 0; idx < codes.size(); idx++)
+	{
+		const unsigned char code = codes[idx];
+		if (this->lengths[code] <= length &&
+			std::memcmp(text, &this->words[code], this->lengths[code]) == 0)
+		{
+			return code;
+		}
+	}
+
+	return ESCAPE;
+}
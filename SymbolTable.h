@@ -0,0 +1,141 @@
+
+#ifndef SYMBOLTABLE_H_
+#define SYMBOLTABLE_H_
+
+#include "String.h"
+#include "StringColumn.h"
+#include "StringView.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * This class stores a dictionary of up to 255 symbols, each one to eight
+ * characters long, which CompressedString uses to shrink text. Compressing
+ * replaces each run of characters which matches a symbol with that symbol's
+ * one byte code, always taking the longest symbol which matches. A character
+ * which begins no symbol is written as the escape code followed by the
+ * character itself.
+ *
+ * The symbols are learned from sample text, so a table trained on a few
+ * thousand typical values (log lines, JSON documents from one API, etc.)
+ * usually shrinks similar text to a third or less of its size. Decompressing
+ * only has to copy one symbol per code, so it runs at close to the speed of
+ * copying the uncompressed text.
+ *
+ * A SymbolTable is never changed after it has been trained, so one table can
+ * be shared by any number of CompressedStrings and threads.
+ *
+ * @example
+ * std::vector<String> samples = loadSomeLogLines();
+ * std::shared_ptr<const SymbolTable> table(new SymbolTable(samples));
+ * CompressedString line(logLine, table);
+ */
+class SymbolTable
+{
+
+public:
+
+	/**
+	 * The code written before a character which begins no symbol.
+	 */
+	static const unsigned char ESCAPE = 255;
+
+	/**
+	 * The longest a symbol can be.
+	 */
+	static const size_t MAX_SYMBOL_LENGTH = 8;
+
+// -----------------------------------------------------------------------------
+// Constructors
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Creates a SymbolTable without any symbols, which escapes every
+	 * character.
+	 */
+	SymbolTable();
+
+	/**
+	 * Trains a SymbolTable on the given samples. Only the first 64 KiB of
+	 * samples are used, as more rarely improves the symbols chosen.
+	 *
+	 * @param samples Text similar to the text to be compressed
+	 */
+	SymbolTable(const std::vector<String>& samples);
+	SymbolTable(const StringColumn& samples);
+
+// -----------------------------------------------------------------------------
+// Table Information
+// -----------------------------------------------------------------------------
+
+	/**
+	 * @return The number of symbols, not including the escape code
+	 */
+	const size_t size() const;
+
+	/**
+	 * @param code The code of the symbol
+	 * @return The symbol's characters
+	 * @throws std::out_of_range If the code is not below size()
+	 */
+	const StringView symbol(unsigned char code) const;
+
+// -----------------------------------------------------------------------------
+// Compressing
+// -----------------------------------------------------------------------------
+
+	/**
+	 * Compresses the given text, appending the codes to the given vector.
+	 *
+	 * @param text The text to be compressed
+	 * @param codes The vector the codes are appended to
+	 */
+	void encode(const StringView& text,
+				std::vector<unsigned char>& codes) const;
+
+	/**
+	 * Decompresses the given codes. Up to MAX_SYMBOL_LENGTH - 1 characters
+	 * past the end of the decompressed text may be overwritten, so the output
+	 * must have that much room to spare.
+	 *
+	 * @param codes The codes to be decompressed
+	 * @param count The number of codes; An escape code and the character after
+	 * 				it count as two
+	 * @param output Where the decompressed text is written
+	 * @return The number of characters decompressed
+	 */
+	size_t decode(const unsigned char* codes, size_t count, char* output) const;
+
+private:
+
+	/**
+	 * Chooses the symbols which save the most space on the given samples.
+	 */
+	void train(const std::vector<StringView>& samples);
+
+	/**
+	 * Replaces every symbol with the given ones and rebuilds the lookup lists.
+	 */
+	void assign(const std::vector<std::string>& symbols);
+
+	/**
+	 * @return The code of the longest symbol which the text begins with, or
+	 * 		   ESCAPE if there is none
+	 */
+	unsigned char longestMatch(const char* text, size_t length) const;
+
+	size_t count;                                 // The number of symbols
+	unsigned long long words[255];                // Each symbol's characters,
+												  // padded with zero bytes
+	unsigned char lengths[255];                   // Each symbol's length
+	std::vector<unsigned char> byFirstChar[256];  // The codes of the symbols
+												  // beginning with each
+												  // character, longest first
+
+};
+
+
+
+#endif
@@ -0,0 +1,129 @@
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * This class times a String operation against a reference implementation
+ * (std::string, std::regex, etc.) doing the same work and fails when the
+ * String takes more than an allowed multiple of the reference's time.
+ * Comparing against a reference run on the same machine in the same process
+ * keeps the thresholds meaningful across machines and build settings, which
+ * absolute times are not.
+ *
+ * Each side is timed several times and the fastest run is kept, which filters
+ * out most of the noise from other processes.
+ *
+ * @example
+ * Benchmark benchmark;
+ * benchmark.compare("indexOf", 1.5,
+ * 		[&]() { return text.indexOf("needle"); },
+ * 		[&]() { return reference.find("needle"); });
+ * return benchmark.result();
+ */
+class Benchmark
+{
+
+public:
+
+	/**
+	 * @param repetitions The number of times each side is timed
+	 */
+	explicit Benchmark(size_t repetitions = 7)
+		: repetitions(repetitions), failures(0), sink(0)
+	{
+		std::cout << std::left << std::setw(36) << "operation"
+				  << std::right << std::setw(12) << "String ms"
+				  << std::setw(14) << "reference ms" << std::setw(9) << "ratio"
+				  << std::setw(9) << "limit" << std::endl;
+	}
+
+	/**
+	 * Times both operations and reports the ratio between them.
+	 *
+	 * @param name The name reported for the operation
+	 * @param maxRatio The most times slower than the reference the String
+	 * 				   operation may be before it counts as a regression
+	 * @param operation The String operation; Its result is kept so that the
+	 * 					compiler cannot optimize the work away
+	 * @param reference The same work done by the reference
+	 * @return Whether the operation was within its limit
+	 */
+	template <typename Operation, typename Reference>
+	bool compare(const std::string& name, double maxRatio,
+				 Operation operation, Reference reference)
+	{
+		const double actual = this->time(operation);
+		const double expected = this->time(reference);
+		const double ratio = actual / std::max(expected, 1e-9);
+		const bool passed = ratio <= maxRatio;
+
+		std::cout << std::left << std::setw(36) << name << std::right
+				  << std::fixed << std::setprecision(3)
+				  << std::setw(12) << actual * 1000
+				  << std::setw(14) << expected * 1000
+				  << std::setprecision(2) << std::setw(9) << ratio
+				  << std::setw(9) << maxRatio
+				  << (passed ? "" : "  REGRESSION") << std::endl;
+
+		if (!passed) ++this->failures;
+		return passed;
+	}
+
+	/**
+	 * @return The exit status of the benchmark; 0 if every operation was
+	 * 		   within its limit
+	 */
+	int result() const
+	{
+		// Printing the sink keeps every result in use
+		std::cout << "(checksum " << this->sink << ")" << std::endl;
+
+		if (this->failures == 0) return 0;
+
+		std::cerr << this->failures
+				  << " operation(s) regressed past their limit" << std::endl;
+		return 1;
+	}
+
+private:
+
+	/**
+	 * @return The fastest of the repeated runs of the operation, in seconds
+	 */
+	template <typename Operation>
+	double time(Operation operation)
+	{
+		double fastest = 0;
+		for (size_t run = 0; run < this->repetitions; run++)
+		{
+			const std::chrono::steady_clock::time_point start =
+					std::chrono::steady_clock::now();
+			this->sink += static_cast<size_t>(operation());
+			const std::chrono::duration<double> elapsed =
+					std::chrono::steady_clock::now() - start;
+
+			if (run == 0 || elapsed.count() < fastest)
+			{
+				fastest = elapsed.count();
+			}
+		}
+
+		return fastest;
+	}
+
+	size_t repetitions;
+	size_t failures;
+	size_t sink;   // Collects every result so none can be optimized away
+
+};
+
+
+
+#endif
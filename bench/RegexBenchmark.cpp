@@ -0,0 +1,166 @@
+
+#include "Benchmark.h"
+#include "Regex.h"
+#include "String.h"
+
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Times Regex against std::regex on log parsing, compiling each pattern once
+// and reusing it for every line as a log parser would. Every limit is below
+// 1, so the benchmark fails unless Regex is faster than std::regex at each.
+
+// The number of lines each operation is run over
+static const size_t LINE_COUNT = 20000;
+
+/**
+ * @return Log lines, most of which hold a user and an action
+ */
+static std::vector<std::string> makeLines()
+{
+	static const char* const ACTIONS[] = {
+		"login", "logout", "view", "purchase", "search"
+	};
+
+	std::mt19937 random(42);
+	std::vector<std::string> lines;
+	lines.reserve(LINE_COUNT);
+
+	for (size_t idx = 0; idx < LINE_COUNT; idx++)
+	{
+		std::string line = "2015-04-01 12:00:" +
+				std::to_string(10 + random() % 50) + " INFO ";
+
+		if (idx % 10 == 0) {
+			line += "heartbeat ok";
+		} else {
+			line += "user=" + std::to_string(random() % 100000) +
+					" action=" + ACTIONS[random() % 5] +
+					" path=/api/v1/items/" + std::to_string(random() % 1000);
+		}
+
+		lines.push_back(line);
+	}
+
+	return lines;
+}
+
+int main()
+{
+	const std::vector<std::string> reference = makeLines();
+	std::vector<String> lines;
+	std::string joined;
+	for (size_t idx = 0; idx < reference.size(); idx++)
+	{
+		lines.push_back(String(reference[idx].c_str()));
+		joined += reference[idx];
+		joined += '\n';
+	}
+	const String text(joined.c_str());
+
+	const Regex userAction("user=(\\d+) action=(\\w+)");
+	const std::regex stdUserAction("user=(\\d+) action=(\\w+)");
+
+	const Regex timestamp("\\d{4}-\\d{2}-\\d{2} [\\d:]+ [A-Z]+ .*");
+	const std::regex stdTimestamp("\\d{4}-\\d{2}-\\d{2} [\\d:]+ [A-Z]+ .*");
+
+	const Regex literal("user");
+	const std::regex stdLiteral("user");
+
+	Benchmark benchmark;
+
+	benchmark.compare("find with groups, per line", 1.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				const Regex::Match match = lines[idx].find(userAction);
+				if (match.found()) total += match.end(2) - match.start(1);
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			std::smatch match;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				if (std::regex_search(reference[idx], match, stdUserAction))
+				{
+					total += match.position(2) + match.length(2) -
+							 match.position(1);
+				}
+			}
+			return total;
+		});
+
+	benchmark.compare("find literal, per line", 1.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].find(literal).found();
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				total += std::regex_search(reference[idx], stdLiteral);
+			}
+			return total;
+		});
+
+	benchmark.compare("matches, per line", 1.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].matches(timestamp);
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				total += std::regex_match(reference[idx], stdTimestamp);
+			}
+			return total;
+		});
+
+	benchmark.compare("findAll with groups, one buffer", 1.0,
+		[&]() {
+			const std::vector<Regex::Match> matches = text.findAll(userAction);
+
+			size_t total = 0;
+			for (size_t idx = 0; idx < matches.size(); idx++)
+			{
+				total += matches[idx].end(2) - matches[idx].start(1);
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (std::sregex_iterator it(joined.begin(), joined.end(),
+										 stdUserAction), end;
+				 it != end; ++it)
+			{
+				total += it->position(2) + it->length(2) - it->position(1);
+			}
+			return total;
+		});
+
+	benchmark.compare("replaceAll with groups, one buffer", 1.0,
+		[&]() {
+			return text.replaceAll(userAction, "$2 by $1").length();
+		},
+		[&]() {
+			return std::regex_replace(joined, stdUserAction, "$2 by $1")
+					.length();
+		});
+
+	return benchmark.result();
+}
@@ -0,0 +1,284 @@
+
+#include "Benchmark.h"
+#include "String.h"
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <string>
+#include <vector>
+
+// Times the String paths which have been hardened against std::string doing
+// the same work, and fails when any of them regresses past its limit. The
+// limits are several times what the String currently takes relative to
+// std::string, which leaves room for noise while still catching a change
+// such as a search turning quadratic or an extra copy of every character.
+
+// The number of lines each operation is run over
+static const size_t LINE_COUNT = 20000;
+
+/**
+ * @return Log lines of varying length, some padded with whitespace and some
+ * 		   made of nothing but whitespace
+ */
+static std::vector<std::string> makeLines()
+{
+	static const char* const ACTIONS[] = {
+		"login", "logout", "view", "purchase", "search"
+	};
+
+	std::mt19937 random(42);
+	std::vector<std::string> lines;
+	lines.reserve(LINE_COUNT);
+
+	for (size_t idx = 0; idx < LINE_COUNT; idx++)
+	{
+		std::string line;
+		if (idx % 8 == 0) line += "  \t";
+
+		line += "2015-04-01 12:00:00 INFO user=" +
+				std::to_string(random() % 100000) + " action=" +
+				ACTIONS[random() % 5] + " path=/api/v1/items/" +
+				std::to_string(random() % 1000);
+
+		if (idx % 8 == 0) line += " \r\n";
+		if (idx % 32 == 0) line = "   \t\t  ";
+
+		lines.push_back(line);
+	}
+
+	return lines;
+}
+
+int main()
+{
+	const std::vector<std::string> reference = makeLines();
+	std::vector<String> lines;
+	lines.reserve(reference.size());
+	for (size_t idx = 0; idx < reference.size(); idx++)
+	{
+		lines.push_back(String(reference[idx].c_str()));
+	}
+
+	const String suffix(" status=200");
+	const std::string referenceSuffix(" status=200");
+
+	Benchmark benchmark;
+
+	benchmark.compare("indexOf (found)", 3.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].indexOf("action=");
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				total += static_cast<unsigned int>(
+						reference[idx].find("action="));
+			}
+			return total;
+		});
+
+	benchmark.compare("indexOf (missing)", 3.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].indexOf("status=500");
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				total += static_cast<unsigned int>(
+						reference[idx].find("status=500"));
+			}
+			return total;
+		});
+
+	benchmark.compare("insert at length()", 3.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				const String& line = lines[idx];
+				total += line.insert(line.length(), suffix).length();
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				std::string inserted(reference[idx]);
+				inserted.insert(inserted.length(), referenceSuffix);
+				total += inserted.length();
+			}
+			return total;
+		});
+
+	benchmark.compare("trim", 3.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].trim().length();
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				const std::string& line = reference[idx];
+				const size_t left = line.find_first_not_of(" \t\n\v\f\r");
+				const size_t right = line.find_last_not_of(" \t\n\v\f\r");
+				total += left == std::string::npos
+						? std::string().length()
+						: line.substr(left, right - left + 1).length();
+			}
+			return total;
+		});
+
+	benchmark.compare("toUppercase", 3.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].toUppercase()[0];
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				std::string uppercase(reference[idx]);
+				for (size_t c = 0; c < uppercase.length(); c++)
+				{
+					uppercase[c] = std::toupper(
+							static_cast<unsigned char>(uppercase[c]));
+				}
+				total += uppercase[0];
+			}
+			return total;
+		});
+
+	benchmark.compare("removeFirst (missing)", 4.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].removeFirst("status=500").length();
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				std::string removed(reference[idx]);
+				const size_t found = removed.find("status=500");
+				if (found != std::string::npos) removed.erase(found, 10);
+				total += removed.length();
+			}
+			return total;
+		});
+
+	benchmark.compare("replaceFirst", 5.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].replaceFirst("INFO", "WARNING").length();
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				std::string replaced(reference[idx]);
+				const size_t found = replaced.find("INFO");
+				if (found != std::string::npos)
+				{
+					replaced.replace(found, 4, "WARNING");
+				}
+				total += replaced.length();
+			}
+			return total;
+		});
+
+	benchmark.compare("replaceAll", 5.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].replaceAll("/", "::").length();
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				const std::string& line = reference[idx];
+				std::string replaced;
+				size_t prevIndex = 0;
+				size_t found;
+				while ((found = line.find('/', prevIndex)) != std::string::npos)
+				{
+					replaced.append(line, prevIndex, found - prevIndex);
+					replaced += "::";
+					prevIndex = found + 1;
+				}
+				replaced.append(line, prevIndex, std::string::npos);
+				total += replaced.length();
+			}
+			return total;
+		});
+
+	benchmark.compare("split", 6.0,
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < lines.size(); idx++)
+			{
+				total += lines[idx].split(" ").size();
+			}
+			return total;
+		},
+		[&]() {
+			size_t total = 0;
+			for (size_t idx = 0; idx < reference.size(); idx++)
+			{
+				const std::string& line = reference[idx];
+				std::vector<std::string> pieces;
+				size_t prevIndex = 0;
+				size_t found;
+				while ((found = line.find(' ', prevIndex)) != std::string::npos)
+				{
+					if (found > prevIndex)
+					{
+						pieces.push_back(
+								line.substr(prevIndex, found - prevIndex));
+					}
+					prevIndex = found + 1;
+				}
+				if (prevIndex < line.length())
+				{
+					pieces.push_back(line.substr(prevIndex));
+				}
+				total += pieces.size();
+			}
+			return total;
+		});
+
+	return benchmark.result();
+}
@@ -0,0 +1,100 @@
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <iostream>
+
+/**
+ * A handful of assertions shared by the tests. Unlike assert, a failed check
+ * reports where it failed and lets the test carry on, so that one run lists
+ * every failure. Each test's main returns Check::result() so that ctest sees
+ * whether anything failed.
+ *
+ * @example
+ * CHECK(s.contains("abc"));
+ * CHECK_EQUAL(s.trim(), String("abc"));
+ * CHECK_THROWS(s.unescapeJson(), std::invalid_argument);
+ * return Check::result();
+ */
+class Check
+{
+
+public:
+
+	/**
+	 * Reports a failed check.
+	 *
+	 * @param file The file the check is in
+	 * @param line The line the check is on
+	 * @param expression The text of the check which failed
+	 */
+	static void fail(const char* file, int line, const char* expression)
+	{
+		std::cerr << file << ":" << line << ": check failed: " << expression
+				  << std::endl;
+
+		++failures();
+	}
+
+	/**
+	 * Reports a failed equality check along with both values.
+	 */
+	template <typename Actual, typename Expected>
+	static void failEqual(const char* file, int line, const char* expression,
+						  const Actual& actual, const Expected& expected)
+	{
+		fail(file, line, expression);
+		std::cerr << "    actual:   \"" << actual << "\"" << std::endl
+				  << "    expected: \"" << expected << "\"" << std::endl;
+	}
+
+	/**
+	 * @return The exit status of the test; 0 if every check passed
+	 */
+	static int result()
+	{
+		if (failures() == 0) return 0;
+
+		std::cerr << failures() << " check(s) failed" << std::endl;
+		return 1;
+	}
+
+private:
+
+	static int& failures()
+	{
+		static int count = 0;
+		return count;
+	}
+
+};
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) Check::fail(__FILE__, __LINE__, #condition); \
+	} while (0)
+
+#define CHECK_EQUAL(actual, expected) \
+	do { \
+		if (!((actual) == (expected))) \
+		{ \
+			Check::failEqual(__FILE__, __LINE__, #actual " == " #expected, \
+							 (actual), (expected)); \
+		} \
+	} while (0)
+
+#define CHECK_THROWS(expression, exception) \
+	do { \
+		bool thrown = false; \
+		try { (void) (expression); } \
+		catch (const exception&) { thrown = true; } \
+		if (!thrown) \
+		{ \
+			Check::fail(__FILE__, __LINE__, \
+						#expression " throws " #exception); \
+		} \
+	} while (0)
+
+
+
+#endif
@@ -0,0 +1,200 @@
+
+#include "Check.h"
+#include "CompressedString.h"
+#include "String.h"
+#include "SymbolTable.h"
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Segment lengths either side of the longest symbol and of the most
+// characters carried from one block to the next, past which indexOf switches
+// to a StreamSearcher
+static const size_t SEGMENT_LENGTHS[] = { 1, 2, 7, 8, 9, 17, 64, 65, 66, 300 };
+static const size_t SEGMENT_LENGTH_COUNT =
+		sizeof(SEGMENT_LENGTHS) / sizeof(SEGMENT_LENGTHS[0]);
+
+/**
+ * @return Log lines like the ones the table is trained on
+ */
+static std::string logLines(size_t count, size_t seed)
+{
+	static const char* const LEVELS[] = { "INFO", "WARN", "ERROR" };
+
+	std::ostringstream lines;
+	for (size_t idx = 0; idx < count; idx++)
+	{
+		const size_t id = (seed + idx) * 2654435761u % 100000;
+		lines << "2015-04-01 12:" << (10 + idx % 50) << " "
+			  << LEVELS[id % 3] << " user=" << id << " action=login path=/api/"
+			  << (id % 7) << "\n";
+	}
+	return lines.str();
+}
+
+/**
+ * @return A table trained on log lines
+ */
+static std::shared_ptr<const SymbolTable> trainedTable()
+{
+	std::vector<String> samples;
+	for (size_t idx = 0; idx < 200; idx++)
+	{
+		samples.push_back(String(logLines(1, idx).c_str()));
+	}
+	return std::shared_ptr<const SymbolTable>(new SymbolTable(samples));
+}
+
+/**
+ * @return Texts which compress to several blocks, including characters which
+ * 		   begin no symbol and so are escaped. Runs of byte 255, which is the
+ * 		   escape code itself, check that an escape is never split from its
+ * 		   character.
+ */
+static std::vector<std::string> sampleTexts()
+{
+	std::vector<std::string> texts;
+	texts.push_back(logLines(100, 1000));
+
+	std::string escaped;
+	for (size_t idx = 0; idx < 40; idx++)
+	{
+		escaped += logLines(1, idx);
+		escaped += std::string(idx % 9, '\xff') + "\x01{~}" +
+				   std::string(idx % 5, '\xfe');
+	}
+	texts.push_back(escaped);
+
+	// Nothing but escapes
+	std::string bytes;
+	for (size_t idx = 0; idx < 3000; idx++)
+	{
+		bytes += static_cast<char>(idx % 2 == 0 ? '\xff' : 128 + idx % 100);
+	}
+	texts.push_back(bytes);
+
+	return texts;
+}
+
+/**
+ * Checks CompressedString::indexOf against String::indexOf for segments of
+ * every length in SEGMENT_LENGTHS taken from throughout the text, so that
+ * many of them span two or more blocks.
+ */
+static void checkIndexOf(const std::string& text,
+						 const std::shared_ptr<const SymbolTable>& table)
+{
+	const String expected(text.c_str());
+	const CompressedString compressed(StringView(text.c_str()), table);
+
+	for (size_t l = 0; l < SEGMENT_LENGTH_COUNT; l++)
+	{
+		const size_t length = SEGMENT_LENGTHS[l];
+		for (size_t start = 0; start + length <= text.length(); start += 7)
+		{
+			const StringView segment(text.data() + start, length);
+			const unsigned int found = expected.indexOf(segment);
+			CHECK_EQUAL(compressed.indexOf(segment),
+						found == String::npos ? StringView::npos : found);
+		}
+	}
+
+	// Segments which are not found, both short and long
+	CHECK_EQUAL(compressed.indexOf(StringView("user=-1")), StringView::npos);
+	const std::string missing = text.substr(0, 200) + "\x02";
+	CHECK_EQUAL(compressed.indexOf(StringView(missing.c_str())),
+				StringView::npos);
+	CHECK_EQUAL(compressed.indexOf(StringView("")), 0u);
+}
+
+// -----------------------------------------------------------------------------
+// Compressing
+// -----------------------------------------------------------------------------
+
+static void testRoundTrip()
+{
+	const std::shared_ptr<const SymbolTable> table = trainedTable();
+	const std::shared_ptr<const SymbolTable> empty(new SymbolTable());
+
+	const std::vector<std::string> texts = sampleTexts();
+	for (size_t idx = 0; idx < texts.size(); idx++)
+	{
+		const StringView text(texts[idx].c_str());
+
+		const CompressedString compressed(text, table);
+		CHECK_EQUAL(compressed.length(), texts[idx].length());
+		CHECK_EQUAL(compressed.decompress(), String(texts[idx].c_str()));
+		CHECK(compressed.table() == table);
+
+		// Without any symbols every character is escaped
+		const CompressedString escaped(text, empty);
+		CHECK_EQUAL(escaped.compressedLength(), 2 * texts[idx].length());
+		CHECK_EQUAL(escaped.decompress(), String(texts[idx].c_str()));
+	}
+
+	// Text like the samples shrinks
+	const CompressedString lines(StringView(texts[0].c_str()), table);
+	CHECK(lines.compressedLength() < texts[0].length() / 2);
+
+	const CompressedString none;
+	CHECK_EQUAL(none.length(), 0u);
+	CHECK_EQUAL(none.decompress(), String(""));
+	CHECK_EQUAL(none.indexOf(StringView("a")), StringView::npos);
+}
+
+static void testNullTable()
+{
+	CHECK_THROWS(CompressedString(StringView("abc"),
+								  std::shared_ptr<const SymbolTable>()),
+				 std::invalid_argument);
+}
+
+static void testSymbols()
+{
+	const std::shared_ptr<const SymbolTable> table = trainedTable();
+	CHECK(table->size() > 0);
+	CHECK(table->size() <= SymbolTable::ESCAPE);
+
+	for (size_t code = 0; code < table->size(); code++)
+	{
+		const StringView symbol =
+				table->symbol(static_cast<unsigned char>(code));
+		CHECK(symbol.length() >= 1);
+		CHECK(symbol.length() <= SymbolTable::MAX_SYMBOL_LENGTH);
+	}
+
+	CHECK_THROWS(table->symbol(static_cast<unsigned char>(table->size())),
+				 std::out_of_range);
+	CHECK_THROWS(table->symbol(SymbolTable::ESCAPE), std::out_of_range);
+	CHECK_THROWS(SymbolTable().symbol(0), std::out_of_range);
+}
+
+// -----------------------------------------------------------------------------
+// Searching
+// -----------------------------------------------------------------------------
+
+static void testIndexOf()
+{
+	const std::shared_ptr<const SymbolTable> table = trainedTable();
+	const std::shared_ptr<const SymbolTable> empty(new SymbolTable());
+
+	const std::vector<std::string> texts = sampleTexts();
+	for (size_t idx = 0; idx < texts.size(); idx++)
+	{
+		checkIndexOf(texts[idx], table);
+		checkIndexOf(texts[idx], empty);
+	}
+}
+
+int main()
+{
+	testRoundTrip();
+	testNullTable();
+	testSymbols();
+	testIndexOf();
+
+	return Check::result();
+}
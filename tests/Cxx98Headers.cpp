@@ -0,0 +1,22 @@
+
+// Only compiled, never run. String.h and the other headers below compiled as
+// C++98 before the library itself needed C++11, and older code including them
+// should keep compiling.
+
+#include "Regex.h"
+#include "StreamReplacer.h"
+#include "StreamSearcher.h"
+#include "String.h"
+#include "StringBuilder.h"
+#include "StringColumn.h"
+#include "StringReader.h"
+#include "StringView.h"
+#include "StringWriter.h"
+#include "SymbolTable.h"
+
+int cxx98Headers()
+{
+	StringBuilder builder;
+	builder.append(String("C++")).append(98);
+	return builder.toString().contains(StringView("98"));
+}
@@ -0,0 +1,96 @@
+
+#include "Check.h"
+#include "FixedString.h"
+#include "String.h"
+
+// -----------------------------------------------------------------------------
+// Compile Time
+// -----------------------------------------------------------------------------
+
+// Each static_assert only compiles if its expression is evaluated at compile
+// time, so these are checked by building this file
+
+constexpr auto HOST = makeFixedString("Host");
+constexpr FixedString<8> PADDED("abc");
+constexpr FixedString<8> EMBEDDED("ab\0cd");
+constexpr FixedString<4> EMPTY;
+
+static_assert(HOST.length() == 4 && HOST.capacity() == 4, "length");
+static_assert(EMPTY.length() == 0 && EMPTY.c_str()[0] == '\0', "empty");
+
+// A shorter literal is padded out to the capacity with null bytes
+static_assert(PADDED.length() == 3 && PADDED.capacity() == 8, "padded");
+static_assert(PADDED[3] == '\0' && PADDED.c_str()[8] == '\0', "padded");
+
+// A literal ends at its first null byte, and the characters after it are
+// never searched or compared
+static_assert(EMBEDDED.length() == 2 && EMBEDDED[2] == '\0', "embedded");
+static_assert(EMBEDDED == "ab" && EMBEDDED == makeFixedString("ab\0xy"),
+			  "embedded");
+static_assert(!EMBEDDED.contains("cd") && EMBEDDED.indexOf("d") ==
+			  FixedString<8>::npos, "embedded");
+
+static_assert(HOST.indexOf("Host") == 0 && HOST.indexOf("st") == 2, "indexOf");
+static_assert(HOST.indexOf("o", 2) == FixedString<4>::npos, "indexOf");
+static_assert(HOST.indexOf("Hosts") == FixedString<4>::npos, "indexOf");
+static_assert(HOST.indexOf("") == 0 && HOST.indexOf(EMPTY, 4) == 4, "indexOf");
+
+static_assert(HOST.contains("os") && HOST.contains(makeFixedString("Ho")),
+			  "contains");
+static_assert(!HOST.contains("host") && PADDED.contains(""), "contains");
+
+// Capacity plays no part in equality
+static_assert(PADDED == makeFixedString("abc") && PADDED == "abc", "==");
+static_assert(PADDED != "ab" && PADDED != "abd" && HOST != PADDED, "!=");
+
+static_assert(makeFixedString("ab") < PADDED, "<");
+static_assert(PADDED < makeFixedString("abd"), "<");
+static_assert(!(PADDED < makeFixedString("abc")), "<");
+static_assert(!(PADDED < makeFixedString("ab")), "<");
+static_assert(EMPTY < PADDED && !(PADDED < EMPTY), "<");
+
+// Characters compare as unsigned, so accented letters come after ASCII
+static_assert(makeFixedString("z") < makeFixedString("\xc3\xa9"), "<");
+
+// -----------------------------------------------------------------------------
+// Conversion
+// -----------------------------------------------------------------------------
+
+static void testStringView()
+{
+	// The view refers to the FixedString's own characters
+	const StringView view = HOST;
+	CHECK(view.data() == HOST.c_str());
+	CHECK_EQUAL(view.length(), 4u);
+	CHECK(view == StringView("Host"));
+
+	// Only the characters before the first null byte are viewed
+	const StringView embedded = EMBEDDED;
+	CHECK_EQUAL(embedded.length(), 2u);
+	CHECK(embedded == StringView("ab"));
+
+	const StringView padded = PADDED;
+	CHECK_EQUAL(padded.length(), 3u);
+	CHECK_EQUAL(padded.toString(), String("abc"));
+
+	const StringView empty = EMPTY;
+	CHECK_EQUAL(empty.length(), 0u);
+}
+
+static void testStringMethods()
+{
+	// String methods which take a StringView take a FixedString directly
+	const String line("GET / HTTP/1.1 Host: example.com");
+	CHECK(line.contains(HOST));
+	CHECK_EQUAL(line.indexOf(HOST), 15u);
+	CHECK(!line.contains(EMBEDDED));
+	CHECK(String("drab").contains(EMBEDDED));
+}
+
+int main()
+{
+	testStringView();
+	testStringMethods();
+
+	return Check::result();
+}
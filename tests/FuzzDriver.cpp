@@ -0,0 +1,108 @@
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// Runs a fuzz target without libFuzzer, for compilers which do not have it.
+// Any files named on the command line are run first, which replays a crash
+// found by libFuzzer, and then -runs=N random inputs are generated from
+// -seed=S. The inputs are built from a small alphabet heavy in whitespace,
+// escaping and UTF-8 bytes so that segments are often found and edge cases
+// are often hit, which pure random bytes rarely manage.
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/**
+ * Reads the number following the given flag, such as -runs=100.
+ *
+ * @return Whether the argument was the flag
+ */
+static bool readFlag(const char* argument, const char* flag,
+					 unsigned long& value)
+{
+	const size_t length = std::strlen(flag);
+	if (std::strncmp(argument, flag, length) != 0) return false;
+
+	value = std::strtoul(argument + length, NULL, 10);
+	return true;
+}
+
+/**
+ * @return A random String of up to maxLength characters
+ */
+static std::string randomString(std::mt19937& random, size_t maxLength)
+{
+	static const char* const PIECES[] = {
+		"a", "b", "ab", "aab", " ", "\t", "\n", "\r", "A", "Z", "0", "9",
+		",", "\"", "'", "&", "<", ">", ";", "\\", "%", "%2", "%41", "$", "$1",
+		"&amp;", "&#", "&#x41;", "\\u00", "\\n", ".", "*", "+", "?", "(", ")",
+		"[", "]", "{", "}", "{2}", "|", "^", "\\d", "\\w", "\\b",
+		"\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xC3", "\x80",
+		"\xED\xA0\x80", "\xF4\x90\x80\x80", "\xC0\xAF", "\xFF"
+	};
+	static const size_t PIECE_COUNT = sizeof(PIECES) / sizeof(PIECES[0]);
+
+	const size_t length = random() % (maxLength + 1);
+
+	std::string text;
+	while (text.length() < length)
+	{
+		text += PIECES[random() % PIECE_COUNT];
+	}
+
+	return text;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned long runs = 100000;
+	unsigned long seed = 1;
+
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if (readFlag(argv[arg], "-runs=", runs)) continue;
+		if (readFlag(argv[arg], "-seed=", seed)) continue;
+
+		std::ifstream file(argv[arg], std::ios::binary);
+		if (!file)
+		{
+			std::cerr << "Could not open " << argv[arg] << std::endl;
+			return 1;
+		}
+
+		const std::vector<char> input((std::istreambuf_iterator<char>(file)),
+									  std::istreambuf_iterator<char>());
+		LLVMFuzzerTestOneInput(
+				reinterpret_cast<const uint8_t*>(input.data()), input.size());
+	}
+
+	std::mt19937 random(seed);
+	for (unsigned long run = 0; run < runs; run++)
+	{
+		// Mostly short Strings, with the occasional long one
+		const size_t maxLength = run % 16 == 0 ? 256 : 16;
+
+		std::string input;
+		input += static_cast<char>(random());
+		input += static_cast<char>(random());
+		input += randomString(random, maxLength);
+		input += '\0';
+		input += randomString(random, maxLength / 4);
+		input += '\0';
+		input += randomString(random, 4);
+
+		LLVMFuzzerTestOneInput(
+				reinterpret_cast<const uint8_t*>(input.data()), input.size());
+	}
+
+	std::cout << "Ran " << runs << " random inputs from seed " << seed
+			  << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,233 @@
+
+#include "Check.h"
+#include "Regex.h"
+#include "String.h"
+
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Patterns whose matches agree with std::regex's ECMAScript grammar
+static const char* const PATTERNS[] = {
+	"abc", "a|ab", "ab|a", "(a+)(b*)", "(a|b)*c", "(\\w+)=(\\w+)",
+	"\\d{2,3}", "[a-c]+?b", "x(y(z)?)?", "^(\\w+)", "(\\w+)$", "\\bab\\b",
+	"(.*)-(.*)", "(a*)b", "[^ ]+ [^ ]+", "user=(\\d+) action=(\\w+)"
+};
+
+static const char* const TEXTS[] = {
+	"", "abc", "aab", "abababc", "key=value other=thing", "12345 678",
+	"aabab", "xyz xy x", "ab cab ab", "first-second-third", "bbbb",
+	"one two three", "2015-04-01 user=4021 action=login path=/a"
+};
+
+static const size_t PATTERN_COUNT = sizeof(PATTERNS) / sizeof(PATTERNS[0]);
+static const size_t TEXT_COUNT = sizeof(TEXTS) / sizeof(TEXTS[0]);
+
+/**
+ * Checks a Regex match, groups included, against the equivalent std::regex
+ * match.
+ */
+static void checkMatch(const Regex::Match& match, const std::cmatch& expected,
+					   const char* text)
+{
+	CHECK(match.found());
+	CHECK_EQUAL(match.groupCount(), expected.size());
+	if (match.groupCount() != expected.size()) return;
+
+	for (size_t group = 0; group < expected.size(); group++)
+	{
+		if (!expected[group].matched)
+		{
+			CHECK_EQUAL(match.start(group), Regex::npos);
+			continue;
+		}
+
+		CHECK_EQUAL(match.start(group),
+					static_cast<size_t>(expected[group].first - text));
+		CHECK_EQUAL(match.end(group),
+					static_cast<size_t>(expected[group].second - text));
+	}
+}
+
+/**
+ * Checks matches, find and findAll of every pattern over every text against
+ * std::regex.
+ */
+static void checkPatterns(const std::vector<Regex>& regexes)
+{
+	for (size_t p = 0; p < PATTERN_COUNT; p++)
+	{
+		const std::regex expected(PATTERNS[p]);
+
+		for (size_t t = 0; t < TEXT_COUNT; t++)
+		{
+			const char* text = TEXTS[t];
+			const StringView view(text);
+
+			CHECK_EQUAL(regexes[p].matches(view),
+						std::regex_match(text, expected));
+
+			std::cmatch first;
+			if (std::regex_search(text, first, expected)) {
+				checkMatch(regexes[p].find(view), first, text);
+			} else {
+				CHECK(!regexes[p].find(view).found());
+			}
+
+			const std::vector<Regex::Match> matches = regexes[p].findAll(view);
+			size_t idx = 0;
+			for (std::cregex_iterator it(text, text + view.length(), expected),
+				 end; it != end; ++it, ++idx)
+			{
+				CHECK(idx < matches.size());
+				if (idx < matches.size()) checkMatch(matches[idx], *it, text);
+			}
+			CHECK_EQUAL(matches.size(), idx);
+		}
+	}
+}
+
+/**
+ * @return Every pattern compiled once
+ */
+static std::vector<Regex> compilePatterns()
+{
+	std::vector<Regex> regexes;
+	for (size_t p = 0; p < PATTERN_COUNT; p++)
+	{
+		regexes.push_back(Regex(PATTERNS[p]));
+	}
+	return regexes;
+}
+
+// -----------------------------------------------------------------------------
+// Matching
+// -----------------------------------------------------------------------------
+
+static void testAgainstStdRegex()
+{
+	const std::vector<Regex> regexes = compilePatterns();
+
+	// The second pass reuses the states cached by the first
+	checkPatterns(regexes);
+	checkPatterns(regexes);
+}
+
+static void testLongMatch()
+{
+	// Long enough that the groups are not filled in by backtracking
+	const std::string text = "<" + std::string(300000, 'a') + "b>";
+	const Regex::Match match =
+			Regex("<(a*)(b)>").find(StringView(text.c_str()));
+
+	CHECK(match.found());
+	CHECK_EQUAL(match.start(1), 1u);
+	CHECK_EQUAL(match.end(1), 300001u);
+	CHECK_EQUAL(match.start(2), 300001u);
+	CHECK_EQUAL(match.end(2), 300002u);
+}
+
+static void testNullableRepetition()
+{
+	// A repeated group which can match nothing is the one place this engine
+	// and std::regex disagree, on the match as well as on the group
+	const Regex::Match match =
+			Regex(".([^a]*?|aa?)+").find(StringView(" b c"));
+
+	CHECK(match.found());
+	CHECK_EQUAL(match.start(), 0u);
+	CHECK_EQUAL(match.end(), 2u);
+	CHECK_EQUAL(match.start(1), 1u);
+	CHECK_EQUAL(match.end(1), 2u);
+
+	std::cmatch expected;
+	CHECK(std::regex_search(" b c", expected, std::regex(".([^a]*?|aa?)+")));
+	CHECK_EQUAL(expected.length(0), 1);
+}
+
+// -----------------------------------------------------------------------------
+// Copying and Threads
+// -----------------------------------------------------------------------------
+
+static void testCopy()
+{
+	Regex regex("(\\d+)");
+	CHECK_EQUAL(regex.find(StringView("ab 12")).start(1), 3u);
+
+	const Regex copy(regex);
+	regex = Regex("[a-z]+");
+
+	CHECK_EQUAL(copy.find(StringView("ab 12")).start(1), 3u);
+	CHECK_EQUAL(regex.find(StringView("ab 12")).end(), 2u);
+	CHECK(regex.matches(StringView("abc")));
+	CHECK(!copy.matches(StringView("abc")));
+}
+
+/**
+ * @return The bounds of every group of every match of every pattern over
+ * 		   every text, one after the other
+ */
+static std::vector<size_t> describe(const std::vector<Regex>& regexes)
+{
+	std::vector<size_t> bounds;
+	for (size_t p = 0; p < PATTERN_COUNT; p++)
+	{
+		for (size_t t = 0; t < TEXT_COUNT; t++)
+		{
+			const std::vector<Regex::Match> matches =
+					regexes[p].findAll(StringView(TEXTS[t]));
+			bounds.push_back(regexes[p].matches(StringView(TEXTS[t])));
+
+			for (size_t idx = 0; idx < matches.size(); idx++)
+			{
+				for (size_t group = 0; group < matches[idx].groupCount();
+					 group++)
+				{
+					bounds.push_back(matches[idx].start(group));
+					bounds.push_back(matches[idx].end(group));
+				}
+			}
+		}
+	}
+	return bounds;
+}
+
+static void testThreads()
+{
+	const std::vector<size_t> expected = describe(compilePatterns());
+
+	// Every thread shares the same Regexes, and so their cached states. The
+	// checks are made afterwards, as Check is not safe to use across threads.
+	const std::vector<Regex> regexes = compilePatterns();
+	std::vector<std::vector<size_t> > results(4);
+
+	std::vector<std::thread> threads;
+	for (size_t idx = 0; idx < results.size(); idx++)
+	{
+		std::vector<size_t>& result = results[idx];
+		threads.push_back(std::thread([&regexes, &result]() {
+			for (size_t run = 0; run < 20; run++)
+			{
+				result = describe(regexes);
+			}
+		}));
+	}
+
+	for (size_t idx = 0; idx < threads.size(); idx++)
+	{
+		threads[idx].join();
+		CHECK(results[idx] == expected);
+	}
+}
+
+int main()
+{
+	testAgainstStdRegex();
+	testLongMatch();
+	testNullableRepetition();
+	testCopy();
+	testThreads();
+
+	return Check::result();
+}
@@ -0,0 +1,169 @@
+
+#include "Check.h"
+#include "StreamReplacer.h"
+#include "StreamSearcher.h"
+#include "String.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Segments which repeat themselves, so partial matches must fall back to a
+// shorter prefix rather than starting again
+static const char* const SEGMENTS[] = {
+	"a", "aa", "aab", "aba", "abab", "needle"
+};
+
+static const char* const TEXTS[] = {
+	"", "a", "aaaa", "aaaaa", "aabaab aaab", "abababab", "ababa abab",
+	"hay needle hay neeneedle needl", "xyz"
+};
+
+static const char* const REPLACEMENTS[] = { "", "<>", "aaa" };
+
+static const size_t SEGMENT_COUNT = sizeof(SEGMENTS) / sizeof(SEGMENTS[0]);
+static const size_t TEXT_COUNT = sizeof(TEXTS) / sizeof(TEXTS[0]);
+static const size_t REPLACEMENT_COUNT =
+		sizeof(REPLACEMENTS) / sizeof(REPLACEMENTS[0]);
+
+/**
+ * @param text The whole text
+ * @param size The number of characters in each chunk
+ * @return The text split into chunks of the given size, the last of which
+ * 		   may be shorter
+ */
+static std::vector<StringView> chunk(const std::string& text, size_t size)
+{
+	std::vector<StringView> chunks;
+	for (size_t idx = 0; idx < text.length(); idx += size)
+	{
+		chunks.push_back(StringView(text.data() + idx,
+									std::min(size, text.length() - idx)));
+	}
+	return chunks;
+}
+
+// -----------------------------------------------------------------------------
+// Searching
+// -----------------------------------------------------------------------------
+
+static void testSearcher()
+{
+	for (size_t s = 0; s < SEGMENT_COUNT; s++)
+	{
+		const StringView segment(SEGMENTS[s]);
+
+		for (size_t t = 0; t < TEXT_COUNT; t++)
+		{
+			const std::string text = TEXTS[t];
+			const std::vector<int> expected =
+					String(TEXTS[t]).indexesOf(segment);
+
+			// Every chunk size up to the segment's length splits some match
+			// at every possible point
+			for (size_t size = 1; size <= segment.length(); size++)
+			{
+				StreamSearcher searcher(segment);
+				std::vector<int> found;
+
+				const std::vector<StringView> chunks = chunk(text, size);
+				for (size_t idx = 0; idx < chunks.size(); idx++)
+				{
+					const std::vector<unsigned long long> positions =
+							searcher.feed(chunks[idx]);
+					found.insert(found.end(), positions.begin(),
+								 positions.end());
+				}
+
+				CHECK(found == expected);
+				CHECK_EQUAL(searcher.position(), text.length());
+			}
+		}
+	}
+}
+
+static void testOverlappingMatches()
+{
+	// The same as indexesOf, the second match starts after the first ends
+	StreamSearcher searcher(StringView("aa"));
+	std::vector<unsigned long long> found;
+	const char* chunks[] = { "a", "aa", "a" };
+	for (size_t idx = 0; idx < 3; idx++)
+	{
+		const std::vector<unsigned long long> positions =
+				searcher.feed(StringView(chunks[idx]));
+		found.insert(found.end(), positions.begin(), positions.end());
+	}
+
+	CHECK_EQUAL(found.size(), 2u);
+	CHECK_EQUAL(found[0], 0u);
+	CHECK_EQUAL(found[1], 2u);
+	CHECK_EQUAL(searcher.partialMatch(), 0u);
+}
+
+static void testReset()
+{
+	StreamSearcher searcher(StringView("needle"));
+	searcher.feed(StringView("hay nee"));
+	CHECK_EQUAL(searcher.partialMatch(), 3u);
+
+	// The characters held before the reset do not join up with the next chunk
+	searcher.reset();
+	CHECK(searcher.feed(StringView("dle")).empty());
+	CHECK_EQUAL(searcher.position(), 3u);
+
+	// An empty segment is never found
+	StreamSearcher empty((StringView("")));
+	CHECK(empty.feed(StringView("abc")).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Replacing
+// -----------------------------------------------------------------------------
+
+static void testReplacer()
+{
+	for (size_t s = 0; s < SEGMENT_COUNT; s++)
+	{
+		const StringView segment(SEGMENTS[s]);
+
+		for (size_t r = 0; r < REPLACEMENT_COUNT; r++)
+		{
+			for (size_t t = 0; t < TEXT_COUNT; t++)
+			{
+				const std::string text = TEXTS[t];
+				const String expected = String(TEXTS[t]).replaceAll(
+						String(SEGMENTS[s]), String(REPLACEMENTS[r]));
+				const size_t count = String(TEXTS[t]).indexesOf(segment).size();
+
+				for (size_t size = 1; size <= segment.length(); size++)
+				{
+					std::ostringstream os;
+					StreamReplacer replacer(segment,
+											StringView(REPLACEMENTS[r]), os);
+
+					const std::vector<StringView> chunks = chunk(text, size);
+					for (size_t idx = 0; idx < chunks.size(); idx++)
+					{
+						replacer.feed(chunks[idx]);
+					}
+					replacer.finish();
+
+					CHECK_EQUAL(String(os.str().c_str()), expected);
+					CHECK_EQUAL(replacer.replacements(), count);
+				}
+			}
+		}
+	}
+}
+
+int main()
+{
+	testSearcher();
+	testOverlappingMatches();
+	testReset();
+	testReplacer();
+
+	return Check::result();
+}
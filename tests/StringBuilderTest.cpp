@@ -0,0 +1,56 @@
+
+#include "Check.h"
+#include "StringBuilder.h"
+
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Appending
+// -----------------------------------------------------------------------------
+
+static void testAppend()
+{
+	StringBuilder builder;
+	builder.append("x = ").append(42).append(',').append(-7LL)
+		   .append(String(" done"));
+
+	CHECK_EQUAL(builder.length(), 14u);
+	CHECK_EQUAL(builder.toString(), String("x = 42,-7 done"));
+
+	// toString hands over the buffer, leaving the builder empty
+	CHECK_EQUAL(builder.length(), 0u);
+	CHECK_EQUAL(builder.toString(), String(""));
+}
+
+static void testSelfAppend()
+{
+	// Each append doubles the length, so the buffer grows, and is freed,
+	// while the characters being appended still lie within it
+	StringBuilder builder;
+	builder.append("ab");
+	std::string expected = "ab";
+	for (size_t run = 0; run < 12; run++)
+	{
+		builder.append(builder.view());
+		expected += expected;
+	}
+	CHECK_EQUAL(builder.toString(), String(expected.c_str()));
+
+	// Only part of the buffer, appended both with and without room to spare
+	builder.reserve(64);
+	builder.append("0123456789");
+	builder.append(builder.view().subview(2, 5));
+	CHECK_EQUAL(builder.toString(), String("0123456789234"));
+
+	builder.append("0123456789abcdef");
+	builder.append(builder.view().subview(10, 16));
+	CHECK_EQUAL(builder.toString(), String("0123456789abcdefabcdef"));
+}
+
+int main()
+{
+	testAppend();
+	testSelfAppend();
+
+	return Check::result();
+}
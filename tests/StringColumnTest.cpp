@@ -0,0 +1,125 @@
+
+#include "Check.h"
+#include "StringColumn.h"
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Copying a whole vector into an arena should never happen by accident
+static_assert(!std::is_convertible<std::vector<String>, StringColumn>::value,
+			  "A std::vector<String> must not convert to a StringColumn");
+
+// The thread counts every batch operation is run with; 0 uses one thread per
+// core
+static const unsigned int THREADS[] = { 1, 4, 0 };
+static const size_t THREAD_COUNTS = sizeof(THREADS) / sizeof(THREADS[0]);
+
+/**
+ * Checks every batch operation on the given values against the same String
+ * method applied to each value in turn.
+ */
+static void checkBatch(const std::vector<String>& values)
+{
+	const StringColumn column(values);
+	CHECK_EQUAL(column.size(), values.size());
+
+	for (size_t run = 0; run < THREAD_COUNTS; run++)
+	{
+		const unsigned int threads = THREADS[run];
+
+		const StringColumn trimmed = column.trim(threads);
+		const StringColumn uppercase = column.toUppercase(threads);
+		const StringColumn lowercase = column.toLowercase(threads);
+		const StringColumn replaced = column.replaceAll("a", "<>", threads);
+		const std::vector<unsigned char> found = column.contains("ab", threads);
+		const std::vector<unsigned long long> hashes = column.hash(threads);
+
+		CHECK_EQUAL(trimmed.size(), values.size());
+		CHECK_EQUAL(uppercase.size(), values.size());
+		CHECK_EQUAL(lowercase.size(), values.size());
+		CHECK_EQUAL(replaced.size(), values.size());
+		CHECK_EQUAL(found.size(), (values.size() + 7) / 8);
+		CHECK_EQUAL(hashes.size(), values.size());
+
+		for (size_t idx = 0; idx < values.size(); idx++)
+		{
+			CHECK_EQUAL(trimmed.at(idx), values[idx].trim());
+			CHECK_EQUAL(uppercase.at(idx), values[idx].toUppercase());
+			CHECK_EQUAL(lowercase.at(idx), values[idx].toLowercase());
+			CHECK_EQUAL(replaced.at(idx), values[idx].replaceAll("a", "<>"));
+			CHECK_EQUAL(StringColumn::isSet(found, idx),
+						values[idx].contains("ab"));
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Empty Columns
+// -----------------------------------------------------------------------------
+
+static void testEmptyColumn()
+{
+	const StringColumn column;
+
+	CHECK_EQUAL(column.size(), 0u);
+	CHECK_EQUAL(column.byteLength(), 0u);
+	CHECK(column.toVector().empty());
+
+	for (size_t run = 0; run < THREAD_COUNTS; run++)
+	{
+		const unsigned int threads = THREADS[run];
+
+		CHECK_EQUAL(column.trim(threads).size(), 0u);
+		CHECK_EQUAL(column.toUppercase(threads).size(), 0u);
+		CHECK_EQUAL(column.toLowercase(threads).size(), 0u);
+		CHECK_EQUAL(column.replaceAll("a", "b", threads).size(), 0u);
+		CHECK(column.contains("a", threads).empty());
+		CHECK(column.hash(threads).empty());
+	}
+
+	checkBatch(std::vector<String>());
+}
+
+static void testEmptyValues()
+{
+	// Every value is empty, so the arena is too
+	checkBatch(std::vector<String>(3, String("")));
+	checkBatch(std::vector<String>(20000, String("")));
+
+	std::vector<String> values(3, String(""));
+	const StringColumn column(values);
+	CHECK_EQUAL(column.byteLength(), 0u);
+	CHECK_EQUAL(column.hash()[0], column.hash()[2]);
+}
+
+// -----------------------------------------------------------------------------
+// Batch Operations
+// -----------------------------------------------------------------------------
+
+static void testBatch()
+{
+	static const char* const VALUES[] = {
+		"", " ", "abc", "  Abc\t", "banana", "AB ab", "\n", "xyz"
+	};
+
+	// Enough values that the columns are split between threads
+	std::vector<String> values;
+	for (size_t idx = 0; idx < 20000; idx++)
+	{
+		values.push_back(String(VALUES[idx % 8]) + idx);
+	}
+	checkBatch(values);
+
+	values.push_back(String(""));
+	checkBatch(values);
+}
+
+int main()
+{
+	testEmptyColumn();
+	testEmptyValues();
+	testBatch();
+
+	return Check::result();
+}
@@ -0,0 +1,528 @@
+
+#include "Regex.h"
+#include "String.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// This fuzz target checks String against a reference built on std::string.
+// Each input is read as two index bytes followed by up to three Strings
+// separated by null bytes: a haystack, a segment to search for, and a
+// replacement. Every String method is run on them and compared with the same
+// operation done on std::strings, and any difference aborts so that libFuzzer
+// (or FuzzDriver.cpp when libFuzzer is not available) reports the input.
+
+/**
+ * Reports a difference from the reference and aborts.
+ */
+static void fail(int line, const char* expression, const std::string& haystack,
+				 const std::string& segment, const std::string& replacement)
+{
+	std::cerr << "StringFuzzer.cpp:" << line << ": mismatch: " << expression
+			  << std::endl
+			  << "    haystack:    \"" << haystack << "\"" << std::endl
+			  << "    segment:     \"" << segment << "\"" << std::endl
+			  << "    replacement: \"" << replacement << "\"" << std::endl;
+
+	std::abort();
+}
+
+#define FUZZ_CHECK(condition) \
+	do { \
+		if (!(condition)) fail(__LINE__, #condition, h, n, r); \
+	} while (0)
+
+// -----------------------------------------------------------------------------
+// Reference Implementations
+// -----------------------------------------------------------------------------
+
+/**
+ * @return The index locations of every non overlapping occurrence of segment
+ */
+static std::vector<size_t> refIndexesOf(const std::string& text,
+										const std::string& segment)
+{
+	std::vector<size_t> indexes;
+	if (segment.empty()) return indexes;
+
+	size_t found = text.find(segment);
+	while (found != std::string::npos)
+	{
+		indexes.push_back(found);
+		found = text.find(segment, found + segment.length());
+	}
+
+	return indexes;
+}
+
+static std::string refReplaceAll(const std::string& text,
+								 const std::string& segment,
+								 const std::string& replacement)
+{
+	const std::vector<size_t> indexes = refIndexesOf(text, segment);
+
+	std::string replaced;
+	size_t prevIndex = 0;
+	for (size_t idx = 0; idx < indexes.size(); idx++)
+	{
+		replaced += text.substr(prevIndex, indexes[idx] - prevIndex);
+		replaced += replacement;
+		prevIndex = indexes[idx] + segment.length();
+	}
+	replaced += text.substr(prevIndex);
+
+	return replaced;
+}
+
+/**
+ * Splits at every occurrence of segment, leaving out empty pieces.
+ */
+static std::vector<std::string> refSplit(const std::string& text,
+										 const std::string& segment)
+{
+	const std::vector<size_t> indexes = refIndexesOf(text, segment);
+
+	std::vector<std::string> pieces;
+	size_t prevIndex = 0;
+	for (size_t idx = 0; idx <= indexes.size(); idx++)
+	{
+		const size_t end = idx < indexes.size() ? indexes[idx] : text.length();
+		if (end > prevIndex)
+		{
+			pieces.push_back(text.substr(prevIndex, end - prevIndex));
+		}
+
+		if (idx < indexes.size()) prevIndex = indexes[idx] + segment.length();
+	}
+
+	return pieces;
+}
+
+static std::string refTrim(const std::string& text)
+{
+	size_t left = 0;
+	size_t right = text.length();
+	while (left < right && std::isspace(static_cast<unsigned char>(text[left])))
+	{
+		++left;
+	}
+	while (right > left &&
+		   std::isspace(static_cast<unsigned char>(text[right - 1])))
+	{
+		--right;
+	}
+
+	return text.substr(left, right - left);
+}
+
+static std::string refCase(const std::string& text, bool uppercase)
+{
+	std::string converted(text);
+	for (size_t idx = 0; idx < converted.length(); idx++)
+	{
+		const unsigned char c = converted[idx];
+		converted[idx] = uppercase ? std::toupper(c) : std::tolower(c);
+	}
+
+	return converted;
+}
+
+/**
+ * Decodes one strictly well formed UTF-8 sequence, written straight from the
+ * table in the Unicode standard rather than from String's decoder.
+ *
+ * @return The number of bytes decoded; 0 if the sequence is not well formed
+ */
+static size_t refDecodeUtf8(const std::string& text, size_t idx,
+							unsigned int& codePoint)
+{
+	const unsigned char lead = text[idx];
+
+	size_t width;
+	unsigned int smallest;
+	if (lead < 0x80) {
+		codePoint = lead;
+		return 1;
+	} else if (lead >= 0xC2 && lead <= 0xDF) {
+		width = 2;
+		smallest = 0x80;
+		codePoint = lead & 0x1F;
+	} else if (lead >= 0xE0 && lead <= 0xEF) {
+		width = 3;
+		smallest = 0x800;
+		codePoint = lead & 0x0F;
+	} else if (lead >= 0xF0 && lead <= 0xF4) {
+		width = 4;
+		smallest = 0x10000;
+		codePoint = lead & 0x07;
+	} else {
+		return 0;
+	}
+
+	if (text.length() - idx < width) return 0;
+	for (size_t offset = 1; offset < width; offset++)
+	{
+		const unsigned char c = text[idx + offset];
+		if ((c & 0xC0) != 0x80) return 0;
+
+		codePoint = (codePoint << 6) | (c & 0x3F);
+	}
+
+	if (codePoint < smallest || codePoint > 0x10FFFF ||
+		(codePoint >= 0xD800 && codePoint <= 0xDFFF))
+	{
+		return 0;
+	}
+
+	return width;
+}
+
+/**
+ * Escapes every character a Regex treats specially, so that the pattern
+ * matches the text literally.
+ */
+static std::string refRegexLiteral(const std::string& text)
+{
+	std::string pattern;
+	for (size_t idx = 0; idx < text.length(); idx++)
+	{
+		const unsigned char c = text[idx];
+		if (!std::isalnum(c) && c != '_') pattern += '\\';
+		pattern += static_cast<char>(c);
+	}
+
+	return pattern;
+}
+
+static bool equal(const std::vector<String>& actual,
+				  const std::vector<std::string>& expected)
+{
+	if (actual.size() != expected.size()) return false;
+
+	for (size_t idx = 0; idx < actual.size(); idx++)
+	{
+		if (actual[idx].toStdString() != expected[idx]) return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Checks
+// -----------------------------------------------------------------------------
+
+static void checkSearching(const std::string& h, const std::string& n,
+						   const std::string& r)
+{
+	const String haystack(h.c_str());
+	const String segment(n.c_str());
+
+	const size_t expected = h.find(n);
+	FUZZ_CHECK(haystack.contains(segment) == (expected != std::string::npos));
+	FUZZ_CHECK(haystack.indexOf(segment) ==
+			   (expected == std::string::npos ? String::npos : expected));
+
+	const std::vector<size_t> indexes = refIndexesOf(h, n);
+	const std::vector<int> actual = haystack.indexesOf(segment);
+	FUZZ_CHECK(actual.size() == indexes.size());
+	for (size_t idx = 0; idx < actual.size() && idx < indexes.size(); idx++)
+	{
+		FUZZ_CHECK(static_cast<size_t>(actual[idx]) == indexes[idx]);
+	}
+}
+
+static void checkManipulation(const std::string& h, const std::string& n,
+							  const std::string& r, size_t first, size_t second)
+{
+	const String haystack(h.c_str());
+	const String segment(n.c_str());
+	const String replacement(r.c_str());
+
+	FUZZ_CHECK(haystack.toUppercase().toStdString() == refCase(h, true));
+	FUZZ_CHECK(haystack.toLowercase().toStdString() == refCase(h, false));
+
+	const size_t start = std::min(first, second);
+	const size_t end = std::max(first, second);
+	FUZZ_CHECK(haystack.substring(start, end).toStdString() ==
+			   h.substr(start, end - start));
+	FUZZ_CHECK(haystack.removeAll(start, end).toStdString() ==
+			   std::string(h).erase(start, end - start));
+	FUZZ_CHECK(haystack.insert(first, segment).toStdString() ==
+			   std::string(h).insert(first, n));
+
+	const std::vector<String> halves = haystack.split(first);
+	FUZZ_CHECK(halves.size() == 2);
+	FUZZ_CHECK(halves[0].toStdString() == h.substr(0, first));
+	FUZZ_CHECK(halves[1].toStdString() == h.substr(first));
+
+	if (first < h.length())
+	{
+		FUZZ_CHECK(haystack.charAt(first) == h[first]);
+		FUZZ_CHECK(haystack[first] == h[first]);
+		FUZZ_CHECK(haystack.remove(first).toStdString() ==
+				   std::string(h).erase(first, 1));
+	}
+
+	// Removing and replacing the first occurrence leaves the String unchanged
+	// when the segment is missing
+	const size_t found = h.find(n);
+	const std::string removedFirst = found == std::string::npos
+			? h : std::string(h).erase(found, n.length());
+	const std::string replacedFirst = found == std::string::npos
+			? h : std::string(h).replace(found, n.length(), r);
+	FUZZ_CHECK(haystack.removeFirst(segment).toStdString() == removedFirst);
+	FUZZ_CHECK(haystack.replaceFirst(segment, replacement).toStdString() ==
+			   replacedFirst);
+
+	FUZZ_CHECK(haystack.removeAll(segment).toStdString() ==
+			   refReplaceAll(h, n, ""));
+	FUZZ_CHECK(haystack.replaceAll(segment, replacement).toStdString() ==
+			   refReplaceAll(h, n, r));
+
+	FUZZ_CHECK(equal(haystack.split(segment), refSplit(h, n)));
+	FUZZ_CHECK(haystack.trim().toStdString() == refTrim(h));
+	FUZZ_CHECK(haystack.toStdString() == h);
+}
+
+static void checkOperators(const std::string& h, const std::string& n,
+						   const std::string& r)
+{
+	const String haystack(h.c_str());
+	const String segment(n.c_str());
+	const String replacement(r.c_str());
+
+	FUZZ_CHECK(haystack.length() == h.length());
+	FUZZ_CHECK(String(h.c_str(), h.length()) == haystack);
+	FUZZ_CHECK((haystack == segment) == (h == n));
+	FUZZ_CHECK((haystack != segment) == (h != n));
+	FUZZ_CHECK(haystack.equalsIgnoreCase(segment) ==
+			   (refCase(h, false) == refCase(n, false)));
+
+	FUZZ_CHECK((haystack + segment).toStdString() == h + n);
+	if (!r.empty())
+	{
+		FUZZ_CHECK((haystack + r[0]).toStdString() == h + r[0]);
+	}
+
+	String appended(haystack);
+	appended += segment;
+	FUZZ_CHECK(appended.toStdString() == h + n);
+
+	String assigned(segment);
+	assigned = haystack;
+	FUZZ_CHECK(assigned.toStdString() == h);
+	assigned = assigned;
+	FUZZ_CHECK(assigned.toStdString() == h);
+
+	std::vector<String> pieces;
+	pieces.push_back(haystack);
+	pieces.push_back(segment);
+	pieces.push_back(haystack);
+	FUZZ_CHECK(String::join(pieces, replacement).toStdString() ==
+			   h + r + n + r + h);
+}
+
+static void checkEscaping(const std::string& h, const std::string& n,
+						  const std::string& r)
+{
+	const String haystack(h.c_str());
+
+	// Escaping must always undo cleanly
+	FUZZ_CHECK(haystack.escapeJson().unescapeJson() == haystack);
+	FUZZ_CHECK(haystack.escapeCsv().unescapeCsv() == haystack);
+	FUZZ_CHECK(haystack.escapeUrl().unescapeUrl() == haystack);
+	FUZZ_CHECK(haystack.escapeHtml().unescapeHtml() == haystack);
+
+	FUZZ_CHECK(haystack.escapeHtml().toStdString() ==
+			   refReplaceAll(refReplaceAll(refReplaceAll(refReplaceAll(
+					   refReplaceAll(h, "&", "&amp;"), "<", "&lt;"),
+					   ">", "&gt;"), "\"", "&quot;"), "'", "&#39;"));
+
+	// Unescaping arbitrary text either succeeds or rejects it as malformed
+	const String (String::*unescapes[])() const = {
+		&String::unescapeJson, &String::unescapeCsv,
+		&String::unescapeUrl, &String::unescapeHtml
+	};
+	for (size_t idx = 0; idx < sizeof(unescapes) / sizeof(unescapes[0]); idx++)
+	{
+		try
+		{
+			(haystack.*unescapes[idx])();
+		}
+		catch (const std::invalid_argument&)
+		{
+		}
+	}
+}
+
+static void checkUtf8(const std::string& h, const std::string& n,
+					  const std::string& r, size_t first, size_t second)
+{
+	const String haystack(h.c_str());
+
+	// Decodes the reference code points along with where each one starts
+	std::vector<unsigned int> codePoints;
+	std::vector<size_t> offsets;
+	bool valid = true;
+	for (size_t idx = 0; idx < h.length(); )
+	{
+		unsigned int codePoint;
+		size_t width = refDecodeUtf8(h, idx, codePoint);
+		if (width == 0)
+		{
+			valid = false;
+			width = 1;
+			codePoint = 0xFFFD;
+		}
+
+		codePoints.push_back(codePoint);
+		offsets.push_back(idx);
+		idx += width;
+	}
+	offsets.push_back(h.length());
+
+	FUZZ_CHECK(haystack.isValidUtf8() == valid);
+	FUZZ_CHECK(haystack.codePointCount() == codePoints.size());
+
+	size_t count = 0;
+	for (String::CodePointIterator it = haystack.codePointBegin();
+		 it != haystack.codePointEnd() && count < codePoints.size(); ++it)
+	{
+		FUZZ_CHECK(*it == codePoints[count++]);
+	}
+	FUZZ_CHECK(count == codePoints.size());
+
+	// Both with and without the code point index
+	const size_t start = std::min(first, second) % (codePoints.size() + 1);
+	const size_t end = std::max(start, std::max(first, second) %
+											   (codePoints.size() + 1));
+	for (int indexed = 0; indexed < 2; indexed++)
+	{
+		if (indexed) haystack.buildCodePointIndex();
+
+		if (start < codePoints.size())
+		{
+			FUZZ_CHECK(haystack.codePointAt(start) == codePoints[start]);
+		}
+		else
+		{
+			bool thrown = false;
+			try
+			{
+				haystack.codePointAt(start);
+			}
+			catch (const std::out_of_range&)
+			{
+				thrown = true;
+			}
+			FUZZ_CHECK(thrown);
+		}
+
+		FUZZ_CHECK(haystack.substringByCodePoint(start, end).toStdString() ==
+				   h.substr(offsets[start], offsets[end] - offsets[start]));
+	}
+}
+
+static void checkRegex(const std::string& h, const std::string& n,
+					   const std::string& r)
+{
+	const String haystack(h.c_str());
+
+	// The segment escaped into a pattern must match exactly where the literal
+	// methods do
+	if (!n.empty())
+	{
+		const Regex literal(String(refRegexLiteral(n).c_str()));
+		const String segment(n.c_str());
+
+		// $ refers to groups within a Regex replacement
+		const std::string plain = refReplaceAll(r, "$", "");
+		const String replacement(plain.c_str());
+
+		FUZZ_CHECK(haystack.matches(literal) == (h == n));
+
+		const Regex::Match match = haystack.find(literal);
+		FUZZ_CHECK(match.found() == (h.find(n) != std::string::npos));
+		FUZZ_CHECK(!match.found() || match.start() == h.find(n));
+
+		const std::vector<size_t> indexes = refIndexesOf(h, n);
+		const std::vector<Regex::Match> matches = haystack.findAll(literal);
+		FUZZ_CHECK(matches.size() == indexes.size());
+		for (size_t idx = 0; idx < indexes.size() && idx < matches.size();
+			 idx++)
+		{
+			FUZZ_CHECK(matches[idx].start() == indexes[idx]);
+			FUZZ_CHECK(matches[idx].end() == indexes[idx] + n.length());
+		}
+
+		FUZZ_CHECK(equal(haystack.split(literal), refSplit(h, n)));
+		FUZZ_CHECK(haystack.replaceAll(literal, replacement) ==
+				   haystack.replaceAll(segment, replacement));
+		FUZZ_CHECK(haystack.replaceFirst(literal, replacement) ==
+				   haystack.replaceFirst(segment, replacement));
+	}
+
+	// The segment as a pattern of its own either compiles or is rejected, and
+	// any match it finds lies within the haystack
+	try
+	{
+		const Regex pattern(String(n.c_str()));
+
+		const Regex::Match match = haystack.find(pattern);
+		FUZZ_CHECK(!match.found() ||
+				   (match.start() <= match.end() && match.end() <= h.length()));
+
+		const std::vector<Regex::Match> matches = haystack.findAll(pattern);
+		size_t prevEnd = 0;
+		for (size_t idx = 0; idx < matches.size(); idx++)
+		{
+			FUZZ_CHECK(matches[idx].start() >= prevEnd);
+			FUZZ_CHECK(matches[idx].end() <= h.length());
+			prevEnd = matches[idx].end();
+		}
+
+		haystack.replaceAll(pattern, String(r.c_str()));
+	}
+	catch (const std::invalid_argument&)
+	{
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if (size < 2) return 0;
+
+	// Strings cannot hold null bytes, so they separate the three Strings
+	std::string pieces[3];
+	size_t piece = 0;
+	for (size_t idx = 2; idx < size; idx++)
+	{
+		if (data[idx] != '\0') {
+			pieces[piece] += static_cast<char>(data[idx]);
+		} else if (piece < 2) {
+			++piece;
+		}
+	}
+
+	const std::string& h = pieces[0];
+	const std::string& n = pieces[1];
+	const std::string& r = pieces[2];
+
+	// Index locations between 0 and the haystack's length inclusive
+	const size_t first = data[0] % (h.length() + 1);
+	const size_t second = data[1] % (h.length() + 1);
+
+	checkSearching(h, n, r);
+	checkManipulation(h, n, r, first, second);
+	checkOperators(h, n, r);
+	checkEscaping(h, n, r);
+	checkUtf8(h, n, r, data[0], data[1]);
+	checkRegex(h, n, r);
+
+	return 0;
+}
@@ -0,0 +1,250 @@
+
+#include "Check.h"
+#include "String.h"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Searching
+// -----------------------------------------------------------------------------
+
+static void testIndexOf()
+{
+	const String s("hello world");
+
+	CHECK_EQUAL(s.indexOf("world"), 6u);
+	CHECK_EQUAL(s.indexOf(""), 0u);
+	CHECK_EQUAL(s.indexOf("xyz"), String::npos);
+	CHECK_EQUAL(String("").indexOf("a"), String::npos);
+	CHECK_EQUAL(s.indexOf("hello world!"), String::npos);
+
+	CHECK(s.contains("o w"));
+	CHECK(!s.contains("O"));
+	CHECK(s.indexesOf("xyz").empty());
+	CHECK_EQUAL(String("aaaa").indexesOf("aa").size(), 2u);
+}
+
+// -----------------------------------------------------------------------------
+// Removing and Replacing
+// -----------------------------------------------------------------------------
+
+/**
+ * @return What the String method reported on std::cerr while removing the
+ * 		   character at the given index
+ */
+static std::string removeReport(const String& s, unsigned int charIndex,
+								String& removed)
+{
+	std::ostringstream report;
+	std::streambuf* original = std::cerr.rdbuf(report.rdbuf());
+	removed = s.remove(charIndex);
+	std::cerr.rdbuf(original);
+
+	return report.str();
+}
+
+static void testRemove()
+{
+	const String s("abc");
+	String removed("");
+
+	CHECK(removeReport(s, 1, removed).empty());
+	CHECK_EQUAL(removed, String("ac"));
+	CHECK(removeReport(s, 2, removed).empty());
+	CHECK_EQUAL(removed, String("ab"));
+
+	// Like substring, out of bounds indexes are reported, and one at the very
+	// end leaves the String unchanged
+	CHECK(!removeReport(s, 3, removed).empty());
+	CHECK_EQUAL(removed, s);
+	CHECK(!removeReport(s, 4, removed).empty());
+	CHECK_EQUAL(removed, String(""));
+	CHECK(!removeReport(String(""), 0, removed).empty());
+	CHECK_EQUAL(removed, String(""));
+}
+
+static void testRemoveFirst()
+{
+	const String s("hello world");
+
+	CHECK_EQUAL(s.removeFirst("o"), String("hell world"));
+	CHECK_EQUAL(s.removeFirst("hello "), String("world"));
+
+	// A missing segment leaves the String unchanged rather than throwing
+	CHECK_EQUAL(s.removeFirst("xyz"), s);
+	CHECK_EQUAL(s.removeFirst("hello world!"), s);
+	CHECK_EQUAL(String("").removeFirst("a"), String(""));
+}
+
+static void testReplaceFirst()
+{
+	const String s("hello world");
+
+	CHECK_EQUAL(s.replaceFirst("o", "0"), String("hell0 world"));
+	CHECK_EQUAL(s.replaceFirst("world", ""), String("hello "));
+	CHECK_EQUAL(s.replaceFirst("", "> "), String("> hello world"));
+
+	// A missing segment leaves the String unchanged rather than throwing
+	CHECK_EQUAL(s.replaceFirst("xyz", "abc"), s);
+	CHECK_EQUAL(String("").replaceFirst("a", "b"), String(""));
+}
+
+static void testReplaceAll()
+{
+	CHECK_EQUAL(String("a.b.c").replaceAll(".", "::"), String("a::b::c"));
+	CHECK_EQUAL(String("aaa").replaceAll("a", "aa"), String("aaaaaa"));
+	CHECK_EQUAL(String("abc").replaceAll("x", "y"), String("abc"));
+	CHECK_EQUAL(String("abc").removeAll("b"), String("ac"));
+}
+
+// -----------------------------------------------------------------------------
+// Inserting
+// -----------------------------------------------------------------------------
+
+static void testInsert()
+{
+	const String s("abc");
+
+	CHECK_EQUAL(s.insert(0, "x"), String("xabc"));
+	CHECK_EQUAL(s.insert(1, "x"), String("axbc"));
+
+	// Inserting at length() appends without reading past the end
+	CHECK_EQUAL(s.insert(3, "x"), String("abcx"));
+	CHECK_EQUAL(String("").insert(0, "x"), String("x"));
+}
+
+// -----------------------------------------------------------------------------
+// Trimming
+// -----------------------------------------------------------------------------
+
+static void testTrim()
+{
+	CHECK_EQUAL(String("  a b \t").trim(), String("a b"));
+	CHECK_EQUAL(String("a").trim(), String("a"));
+	CHECK_EQUAL(String("").trim(), String(""));
+
+	// All whitespace trims down to nothing without running off either end
+	CHECK_EQUAL(String(" ").trim(), String(""));
+	CHECK_EQUAL(String(" \t\n\v\f\r ").trim(), String(""));
+}
+
+// -----------------------------------------------------------------------------
+// Case Conversion
+// -----------------------------------------------------------------------------
+
+static void testCaseConversion()
+{
+	CHECK_EQUAL(String("Hello, World!").toUppercase(), String("HELLO, WORLD!"));
+	CHECK_EQUAL(String("Hello, World!").toLowercase(), String("hello, world!"));
+	CHECK_EQUAL(String("").toUppercase(), String(""));
+
+	// Long enough that a buffer on the stack would overflow it
+	const std::string large(16 * 1024 * 1024, 'a');
+	const String uppercase = String(large.c_str()).toUppercase();
+	CHECK_EQUAL(uppercase.length(), large.length());
+	CHECK(uppercase.toStdString() == std::string(large.length(), 'A'));
+}
+
+// -----------------------------------------------------------------------------
+// Escaping
+// -----------------------------------------------------------------------------
+
+static void testUnescape()
+{
+	CHECK_EQUAL(String("a\\\"b\\u00e9\\ud83d\\ude00").unescapeJson(),
+				String("a\"b\xC3\xA9\xF0\x9F\x98\x80"));
+	CHECK_EQUAL(String("a%20b%2500").unescapeUrl(), String("a b%00"));
+	CHECK_EQUAL(String("&lt;&#233;&#x1;").unescapeHtml(),
+				String("<\xC3\xA9\x01"));
+
+	// The lowest code points other than null are kept
+	CHECK_EQUAL(String("\\u0001").unescapeJson(), String("\x01"));
+	CHECK_EQUAL(String("%01").unescapeUrl(), String("\x01"));
+}
+
+static void testUnescapeNull()
+{
+	// A null byte would cut the String short, losing the text after it, so
+	// an escaped null is rejected in every format
+	CHECK_THROWS(String("\\u0000").unescapeJson(), std::invalid_argument);
+	CHECK_THROWS(String("ab\\u0000cd").unescapeJson(), std::invalid_argument);
+	CHECK_THROWS(String("%00").unescapeUrl(), std::invalid_argument);
+	CHECK_THROWS(String("ab%00cd").unescapeUrl(), std::invalid_argument);
+	CHECK_THROWS(String("&#0;").unescapeHtml(), std::invalid_argument);
+	CHECK_THROWS(String("ab&#x0;cd").unescapeHtml(), std::invalid_argument);
+}
+
+// -----------------------------------------------------------------------------
+// UTF-8
+// -----------------------------------------------------------------------------
+
+static void testUtf8()
+{
+	// "h", "é", "€" and "😀" take up one, two, three and four bytes
+	const String s("h\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+
+	CHECK(s.isValidUtf8());
+	CHECK_EQUAL(s.codePointCount(), 4u);
+	CHECK_EQUAL(s.codePointAt(2), 0x20ACu);
+	CHECK_EQUAL(s.substringByCodePoint(1, 3), String("\xC3\xA9\xE2\x82\xAC"));
+
+	CHECK(!String("a\xC3").isValidUtf8());
+	CHECK_EQUAL(String("a\xC3").codePointCount(), 2u);
+}
+
+static void testUtf8Threads()
+{
+	// Every thread fills in the same String's cache at once. The checks are
+	// made afterwards, as Check is not safe to use across threads.
+	std::string text;
+	for (size_t idx = 0; idx < 1000; idx++) text += "ab\xC3\xA9\xE2\x82\xAC";
+	const String s(text.c_str());
+
+	std::vector<std::vector<unsigned int> > results(4);
+	std::vector<std::thread> threads;
+	for (size_t idx = 0; idx < results.size(); idx++)
+	{
+		std::vector<unsigned int>& result = results[idx];
+		threads.push_back(std::thread([&s, &result, idx]() {
+			if (idx % 2 == 0) s.buildCodePointIndex();
+			result.push_back(s.isValidUtf8());
+			result.push_back(s.codePointCount());
+			for (unsigned int point = 0; point < 4000; point += 7)
+			{
+				result.push_back(s.codePointAt(point));
+			}
+		}));
+	}
+
+	for (size_t idx = 0; idx < threads.size(); idx++)
+	{
+		threads[idx].join();
+		CHECK(results[idx] == results[0]);
+	}
+	CHECK_EQUAL(results[0][0], 1u);
+	CHECK_EQUAL(results[0][1], 4000u);
+	CHECK_EQUAL(results[0][2], static_cast<unsigned int>('a'));
+}
+
+int main()
+{
+	testIndexOf();
+	testRemove();
+	testRemoveFirst();
+	testReplaceFirst();
+	testReplaceAll();
+	testInsert();
+	testTrim();
+	testCaseConversion();
+	testUnescape();
+	testUnescapeNull();
+	testUtf8();
+	testUtf8Threads();
+
+	return Check::result();
+}
@@ -0,0 +1,250 @@
+
+#include "Check.h"
+#include "StringReader.h"
+#include "StringWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * A stream buffer which takes a limited number of bytes and then fails, like
+ * a disk running out of space.
+ */
+class LimitedBuffer : public std::streambuf
+{
+
+public:
+
+	explicit LimitedBuffer(size_t capacity) : capacity(capacity) {}
+
+	std::string bytes;
+
+protected:
+
+	std::streamsize xsputn(const char* chars, std::streamsize count)
+	{
+		const size_t room = this->capacity - this->bytes.size();
+		const size_t taken = std::min(static_cast<size_t>(count), room);
+		this->bytes.append(chars, taken);
+		return static_cast<std::streamsize>(taken);
+	}
+
+	int_type overflow(int_type c)
+	{
+		if (traits_type::eq_int_type(c, traits_type::eof()) ||
+			this->bytes.size() == this->capacity)
+		{
+			return traits_type::eof();
+		}
+
+		this->bytes += traits_type::to_char_type(c);
+		return c;
+	}
+
+private:
+
+	size_t capacity;
+
+};
+
+// The file written and read back, in the directory the test is run from
+static const char* const PATH = "StringWriterTest.strings";
+
+/**
+ * @return The Strings every test writes and reads back
+ */
+static std::vector<String> sampleValues()
+{
+	std::vector<String> values;
+	values.push_back(String(""));
+	values.push_back(String("abc"));
+	values.push_back(String(std::string(100000, 'x').c_str()));
+	values.push_back(String("last"));
+	return values;
+}
+
+/**
+ * @return The bytes StringWriter writes for the given Strings
+ */
+static std::string writeAll(const std::vector<String>& values)
+{
+	std::ostringstream os;
+	StringWriter writer(os);
+	writer.write(values.begin(), values.end());
+	writer.flush();
+	return os.str();
+}
+
+/**
+ * Replaces the file at PATH with the given bytes.
+ */
+static void writeFile(const std::string& bytes)
+{
+	std::ofstream file(PATH, std::ios::binary | std::ios::trunc);
+	file.write(bytes.data(), bytes.length());
+}
+
+// -----------------------------------------------------------------------------
+// Writing
+// -----------------------------------------------------------------------------
+
+static void testRoundTrip()
+{
+	const std::vector<String> values = sampleValues();
+
+	std::ostringstream os;
+	{
+		StringWriter writer(os);
+		writer.write(values.begin(), values.end());
+		writer.flush();
+		CHECK_EQUAL(writer.count(), 4u);
+	}
+
+	const std::string bytes = os.str();
+	const StringReader reader(bytes.data(), bytes.length());
+	CHECK(reader.toVector() == values);
+}
+
+// -----------------------------------------------------------------------------
+// Reading
+// -----------------------------------------------------------------------------
+
+static void testFile()
+{
+	const std::vector<String> values = sampleValues();
+	writeFile(writeAll(values));
+	{
+		const StringReader reader(PATH);
+		CHECK_EQUAL(reader.size(), values.size());
+		CHECK_EQUAL(reader.byteLength(), 100007u);
+		CHECK(reader.toVector() == values);
+		CHECK(reader[3] == StringView("last"));
+		CHECK_EQUAL(reader.toColumn().size(), values.size());
+	}
+
+	// An empty file cannot be mapped, so it is read the other way, and then
+	// rejected as it has no header
+	writeFile("");
+	CHECK_THROWS(StringReader(PATH), std::invalid_argument);
+
+	std::remove(PATH);
+	CHECK_THROWS(StringReader(PATH), std::runtime_error);
+}
+
+static void testTruncated()
+{
+	const std::string bytes = writeAll(sampleValues());
+
+	// Cut off within the header, the first String's length and the last
+	// String
+	const size_t cuts[] = { 0, 5, 10, bytes.length() - 1 };
+	for (size_t idx = 0; idx < sizeof(cuts) / sizeof(cuts[0]); idx++)
+	{
+		CHECK_THROWS(StringReader(bytes.data(), cuts[idx]),
+					 std::invalid_argument);
+	}
+
+	// The mapped file is released again when the constructor throws
+	writeFile(bytes.substr(0, bytes.length() - 1));
+	CHECK_THROWS(StringReader(PATH), std::invalid_argument);
+	std::remove(PATH);
+
+	// Cut off between two Strings, the bytes are still well formed
+	const StringReader reader(bytes.data(), StringWriter::HEADER_SIZE +
+												StringWriter::LENGTH_SIZE);
+	CHECK_EQUAL(reader.size(), 1u);
+	CHECK(reader[0] == StringView(""));
+}
+
+static void testBadHeader()
+{
+	const std::string bytes = writeAll(sampleValues());
+
+	std::string magic = bytes;
+	magic[0] = 'X';
+	CHECK_THROWS(StringReader(magic.data(), magic.length()),
+				 std::invalid_argument);
+
+	// The version follows the magic number
+	std::string version = bytes;
+	version[4]++;
+	CHECK_THROWS(StringReader(version.data(), version.length()),
+				 std::invalid_argument);
+
+	const std::string text = "not written by StringWriter";
+	CHECK_THROWS(StringReader(text.data(), text.length()),
+				 std::invalid_argument);
+}
+
+// -----------------------------------------------------------------------------
+// Failing Streams
+// -----------------------------------------------------------------------------
+
+static void testBadStream()
+{
+	std::ostringstream os;
+	os.setstate(std::ios::badbit);
+
+	// The header and small Strings wait in the buffer until flush
+	StringWriter writer(os);
+	writer.write(StringView("abc"));
+	CHECK_THROWS(writer.flush(), std::runtime_error);
+
+	// Anything too big for the buffer is written, and checked, straight away
+	const std::string large(200000, 'x');
+	CHECK_THROWS(writer.write(StringView(large.c_str())), std::runtime_error);
+}
+
+static void testStreamFillingUp()
+{
+	LimitedBuffer buffer(100);
+	std::ostream os(&buffer);
+
+	StringWriter writer(os);
+	writer.write(StringView("fits"));
+	writer.flush();
+	CHECK(os.good());
+
+	const std::string large(1000, 'x');
+	writer.write(StringView(large.c_str()));
+	CHECK_THROWS(writer.flush(), std::runtime_error);
+	CHECK_EQUAL(buffer.bytes.size(), 100u);
+}
+
+static void testDestructorAfterFailure()
+{
+	// The failed bytes are dropped, so the destructor neither writes them
+	// again nor throws
+	std::ostringstream os;
+	os.setstate(std::ios::badbit);
+	{
+		StringWriter writer(os);
+		writer.write(StringView("abc"));
+		CHECK_THROWS(writer.flush(), std::runtime_error);
+	}
+
+	// The destructor cannot report a failure, so it must not throw one
+	{
+		StringWriter writer(os);
+		writer.write(StringView("abc"));
+	}
+}
+
+int main()
+{
+	testRoundTrip();
+	testFile();
+	testTruncated();
+	testBadHeader();
+	testBadStream();
+	testStreamFillingUp();
+	testDestructorAfterFailure();
+
+	return Check::result();
+}